@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief STS3x daemon for Linux
+ *
+ * Owns all STS3x sensors of a host, samples each of them on its own interval
+ * and publishes the readings in POSIX shared memory (see sts3x_shm.h). Sensors
+ * which are due at the same time are measured together with
+ * sts3x_measure_blocking_read_batch(). Clients read the latest values with the
+ * functions of sts3x_shm.h without accessing the I2C bus.
+ *
+ * Usage: sts3x-daemon [-n name] [-c capacity] [-r repeatability] SENSOR...
+ *
+ *   -n name            name of the shared memory object (default "/sts3x")
+ *   -c capacity        number of readings kept in the ring (default 1024)
+ *   -r repeatability   0 (high, default), 1 (medium) or 2 (low)
+ *   SENSOR             [mux_address:channel/]address[@interval_msec], e.g.
+ *                      0x4a@1000 or 0x72:3/0x4b@250 for a sensor on channel 3
+ *                      of a multiplexer at 0x72. The default interval is 1s.
+ *
+ * The daemon runs in the foreground until it receives SIGINT or SIGTERM and
+ * removes the shared memory object on exit.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sts3x.h"
+#include "sts3x_shm.h"
+
+#define STS3X_DAEMON_MAX_SENSORS 64
+#define STS3X_DAEMON_DEFAULT_CAPACITY 1024
+#define STS3X_DAEMON_DEFAULT_INTERVAL_MSEC 1000
+
+struct sts3x_daemon_sensor {
+    struct sts3x_dev dev;
+    struct sts3x_i2c_mux_channel mux_channel;
+    uint32_t interval_msec;
+    uint64_t next_usec; /* when the sensor is due next */
+};
+
+static const struct sts3x_retry_policy retry_policy =
+    STS3X_RETRY_POLICY_DEFAULT;
+
+static struct sts3x_daemon_sensor sensors[STS3X_DAEMON_MAX_SENSORS];
+static uint16_t num_sensors;
+static volatile sig_atomic_t running = 1;
+
+static void stop(int signal) {
+    (void)signal;
+    running = 0;
+}
+
+static uint64_t monotonic_usec(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void sleep_until_usec(uint64_t usec) {
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(usec / 1000000u);
+    ts.tv_nsec = (long)(usec % 1000000u) * 1000;
+    /* returns early on signals, the main loop then checks running */
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static int parse_number(const char* str, char** end, uint32_t* value) {
+    unsigned long number;
+
+    errno = 0;
+    number = strtoul(str, end, 0);
+    if (errno || *end == str || number > 0xFFFFFFFFul)
+        return -1;
+    *value = (uint32_t)number;
+    return 0;
+}
+
+/* parses [mux_address:channel/]address[@interval_msec] */
+static int parse_sensor(const char* arg, struct sts3x_daemon_sensor* sensor) {
+    uint32_t address = 0;
+    uint32_t interval_msec = STS3X_DAEMON_DEFAULT_INTERVAL_MSEC;
+    uint32_t mux_address = 0;
+    uint32_t channel = 0;
+    char* end;
+
+    if (strchr(arg, '/')) {
+        if (parse_number(arg, &end, &mux_address) || *end != ':' ||
+            parse_number(end + 1, &end, &channel) || *end != '/' ||
+            mux_address > 0x7F || channel > 7)
+            return -1;
+        arg = end + 1;
+    }
+    if (parse_number(arg, &end, &address) || address > 0x7F)
+        return -1;
+    if (*end == '@' &&
+        (parse_number(end + 1, &end, &interval_msec) || interval_msec == 0))
+        return -1;
+    if (*end)
+        return -1;
+
+    sts3x_init_dev(&sensor->dev, (uint8_t)address);
+    sensor->mux_channel.mux_address = (uint8_t)mux_address;
+    sensor->mux_channel.channel = (uint8_t)channel;
+    if (mux_address) {
+        sensor->dev.select_bus = sts3x_select_i2c_mux_channel;
+        sensor->dev.bus = &sensor->mux_channel;
+    }
+    sensor->interval_msec = interval_msec;
+    return 0;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [-n name] [-c capacity] [-r repeatability] SENSOR...\n"
+            "  SENSOR: [mux_address:channel/]address[@interval_msec]\n",
+            program);
+}
+
+/* measures all due sensors together and publishes their readings */
+static uint64_t sample_due_sensors(struct sts3x_shm* shm, uint64_t now) {
+    static struct sts3x_dev batch[STS3X_DAEMON_MAX_SENSORS];
+    int32_t temperatures[STS3X_DAEMON_MAX_SENSORS];
+    int16_t status[STS3X_DAEMON_MAX_SENSORS];
+    uint16_t due[STS3X_DAEMON_MAX_SENSORS];
+    struct sts3x_shm_reading reading;
+    struct sts3x_daemon_sensor* sensor;
+    uint64_t next = UINT64_MAX;
+    uint16_t num_due = 0;
+    uint16_t i;
+
+    for (i = 0; i < num_sensors; ++i) {
+        if (sensors[i].next_usec <= now) {
+            due[num_due] = i;
+            batch[num_due++] = sensors[i].dev;
+        }
+    }
+
+    if (num_due) {
+        sts3x_measure_blocking_read_batch(batch, num_due, temperatures, status);
+        now = monotonic_usec();
+        for (i = 0; i < num_due; ++i) {
+            sensor = &sensors[due[i]];
+            sensor->dev = batch[i];
+            reading.timestamp_usec = now;
+            reading.temperature = status[i] ? 0 : temperatures[i];
+            reading.status = status[i];
+            reading.sensor = due[i];
+            sts3x_shm_publish(shm, &reading);
+
+            /* skip missed intervals instead of catching up with a burst */
+            sensor->next_usec += (uint64_t)sensor->interval_msec * 1000u;
+            if (sensor->next_usec <= now)
+                sensor->next_usec =
+                    now + (uint64_t)sensor->interval_msec * 1000u;
+        }
+    }
+
+    for (i = 0; i < num_sensors; ++i) {
+        if (sensors[i].next_usec < next)
+            next = sensors[i].next_usec;
+    }
+    return next;
+}
+
+int main(int argc, char** argv) {
+    struct sts3x_shm_sensor_info info;
+    struct sts3x_shm shm;
+    struct sigaction action;
+    const char* name = STS3X_SHM_DEFAULT_NAME;
+    uint32_t capacity = STS3X_DAEMON_DEFAULT_CAPACITY;
+    uint32_t repeatability = 0;
+    uint64_t now;
+    char* end;
+    uint16_t i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:c:r:")) != -1) {
+        switch (opt) {
+            case 'n':
+                name = optarg;
+                break;
+            case 'c':
+                if (parse_number(optarg, &end, &capacity) || *end ||
+                    capacity == 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'r':
+                if (parse_number(optarg, &end, &repeatability) || *end ||
+                    repeatability > 2) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind == argc || argc - optind > STS3X_DAEMON_MAX_SENSORS) {
+        usage(argv[0]);
+        return 1;
+    }
+    for (; optind < argc; ++optind) {
+        if (parse_sensor(argv[optind], &sensors[num_sensors])) {
+            fprintf(stderr, "invalid sensor '%s'\n", argv[optind]);
+            usage(argv[0]);
+            return 1;
+        }
+        num_sensors++;
+    }
+
+    if (sts3x_shm_create(&shm, name, num_sensors, capacity)) {
+        perror("cannot create shared memory");
+        return 1;
+    }
+
+    sensirion_i2c_init();
+    now = monotonic_usec();
+    for (i = 0; i < num_sensors; ++i) {
+        struct sts3x_daemon_sensor* sensor = &sensors[i];
+
+        sts3x_set_repeatability_dev(&sensor->dev, (uint8_t)repeatability);
+        sts3x_set_retry_policy_dev(&sensor->dev, &retry_policy);
+        memset(&info, 0, sizeof(info));
+        if (sts3x_probe_dev(&sensor->dev) != STATUS_OK ||
+            sts3x_read_serial_dev(&sensor->dev, &info.serial) != STATUS_OK)
+            fprintf(stderr, "sensor %u at 0x%02x not responding\n", i,
+                    sensor->dev.address);
+        info.interval_msec = sensor->interval_msec;
+        info.address = sensor->dev.address;
+        info.mux_address = sensor->mux_channel.mux_address;
+        info.mux_channel = sensor->mux_channel.channel;
+        sts3x_shm_set_sensor_info(&shm, i, &info);
+        sensor->next_usec = now;
+    }
+    sts3x_shm_start(&shm);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    while (running)
+        sleep_until_usec(sample_due_sensors(&shm, monotonic_usec()));
+
+    sts3x_shm_close(&shm);
+    sts3x_shm_unlink(name);
+    sensirion_i2c_release();
+    return 0;
+}
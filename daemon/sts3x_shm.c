@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Shared memory ring of STS3x readings, implementation
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sensirion_arch_config.h"
+#include "sts3x.h"
+#include "sts3x_shm.h"
+
+#define STS3X_SHM_ALIGN(size) (((size) + 7u) & ~(size_t)7u)
+
+static size_t sts3x_shm_sensors_offset(void) {
+    return STS3X_SHM_ALIGN(sizeof(struct sts3x_shm_header));
+}
+
+static size_t sts3x_shm_latest_offset(uint16_t num_sensors) {
+    return sts3x_shm_sensors_offset() +
+           STS3X_SHM_ALIGN(num_sensors * sizeof(struct sts3x_shm_sensor_info));
+}
+
+static size_t sts3x_shm_ring_offset(uint16_t num_sensors) {
+    return sts3x_shm_latest_offset(num_sensors) +
+           num_sensors * sizeof(struct sts3x_shm_slot);
+}
+
+static size_t sts3x_shm_size(uint16_t num_sensors, uint32_t capacity) {
+    return sts3x_shm_ring_offset(num_sensors) +
+           (size_t)capacity * sizeof(struct sts3x_shm_slot);
+}
+
+static void sts3x_shm_map(struct sts3x_shm* shm, void* base, size_t size,
+                          uint16_t num_sensors) {
+    uint8_t* bytes = (uint8_t*)base;
+
+    shm->header = (struct sts3x_shm_header*)base;
+    shm->sensors = (struct sts3x_shm_sensor_info*)(bytes +
+                                                   sts3x_shm_sensors_offset());
+    shm->latest =
+        (struct sts3x_shm_slot*)(bytes + sts3x_shm_latest_offset(num_sensors));
+    shm->ring =
+        (struct sts3x_shm_slot*)(bytes + sts3x_shm_ring_offset(num_sensors));
+    shm->cursor = 0;
+    shm->size = size;
+}
+
+static void sts3x_shm_write_slot(struct sts3x_shm_slot* slot, uint64_t index,
+                                 const struct sts3x_shm_reading* reading) {
+    uint32_t sequence = slot->sequence;
+    uint32_t next = sequence + 2;
+
+    if (next == 0)
+        next = 2; /* 0 marks slots which were never written */
+    __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->index = index;
+    slot->reading = *reading;
+    __atomic_store_n(&slot->sequence, next, __ATOMIC_RELEASE);
+}
+
+static int16_t sts3x_shm_read_slot(const struct sts3x_shm_slot* slot,
+                                   uint64_t* index,
+                                   struct sts3x_shm_reading* reading) {
+    uint32_t sequence;
+    uint16_t attempts;
+
+    for (attempts = 0; attempts < STS3X_SHM_READ_ATTEMPTS; ++attempts) {
+        sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if (sequence & 1)
+            continue;
+        *index = slot->index;
+        *reading = slot->reading;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == sequence)
+            return STATUS_OK;
+    }
+    return STATUS_IN_PROGRESS;
+}
+
+int16_t sts3x_shm_create(struct sts3x_shm* shm, const char* name,
+                         uint16_t num_sensors, uint32_t capacity) {
+    uint32_t ring_capacity = 1;
+    size_t size;
+    void* base;
+    int fd;
+
+    if (num_sensors == 0)
+        return STATUS_ERR_BAD_DATA;
+    while (ring_capacity < capacity && ring_capacity < 0x80000000u)
+        ring_capacity <<= 1;
+    size = sts3x_shm_size(num_sensors, ring_capacity);
+
+    shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+        return STATUS_ERR_BAD_DATA;
+    /* the new object is zero filled, i.e. has no readings and no magic */
+    if (ftruncate(fd, (off_t)size) < 0) {
+        close(fd);
+        shm_unlink(name);
+        return STATUS_ERR_BAD_DATA;
+    }
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name);
+        return STATUS_ERR_BAD_DATA;
+    }
+
+    sts3x_shm_map(shm, base, size, num_sensors);
+    shm->header->version = STS3X_SHM_VERSION;
+    shm->header->num_sensors = num_sensors;
+    shm->header->capacity = ring_capacity;
+    return STATUS_OK;
+}
+
+void sts3x_shm_set_sensor_info(struct sts3x_shm* shm, uint16_t sensor,
+                               const struct sts3x_shm_sensor_info* info) {
+    if (sensor < shm->header->num_sensors)
+        shm->sensors[sensor] = *info;
+}
+
+void sts3x_shm_start(struct sts3x_shm* shm) {
+    __atomic_store_n(&shm->header->magic, STS3X_SHM_MAGIC, __ATOMIC_RELEASE);
+}
+
+void sts3x_shm_publish(struct sts3x_shm* shm,
+                       const struct sts3x_shm_reading* reading) {
+    struct sts3x_shm_header* header = shm->header;
+    uint64_t head = header->head;
+
+    if (reading->sensor >= header->num_sensors)
+        return;
+    sts3x_shm_write_slot(&shm->latest[reading->sensor], head, reading);
+    sts3x_shm_write_slot(&shm->ring[head & (header->capacity - 1)], head,
+                         reading);
+    __atomic_store_n(&header->head, head + 1, __ATOMIC_RELEASE);
+}
+
+int16_t sts3x_shm_open(struct sts3x_shm* shm, const char* name) {
+    const struct sts3x_shm_header* header;
+    struct stat st;
+    void* base;
+    int fd;
+
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return STATUS_ERR_BAD_DATA;
+    if (fstat(fd, &st) < 0 ||
+        (size_t)st.st_size < sizeof(struct sts3x_shm_header)) {
+        close(fd);
+        return STATUS_ERR_BAD_DATA;
+    }
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return STATUS_ERR_BAD_DATA;
+
+    header = (const struct sts3x_shm_header*)base;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != STS3X_SHM_MAGIC ||
+        header->version != STS3X_SHM_VERSION || header->num_sensors == 0 ||
+        (size_t)st.st_size <
+            sts3x_shm_size(header->num_sensors, header->capacity)) {
+        munmap(base, (size_t)st.st_size);
+        return STATUS_ERR_BAD_DATA;
+    }
+
+    sts3x_shm_map(shm, base, (size_t)st.st_size, header->num_sensors);
+    return STATUS_OK;
+}
+
+void sts3x_shm_close(struct sts3x_shm* shm) {
+    if (shm->header)
+        munmap(shm->header, shm->size);
+    shm->header = NULL;
+}
+
+void sts3x_shm_unlink(const char* name) {
+    shm_unlink(name);
+}
+
+uint16_t sts3x_shm_num_sensors(const struct sts3x_shm* shm) {
+    return shm->header->num_sensors;
+}
+
+int16_t sts3x_shm_get_sensor_info(const struct sts3x_shm* shm, uint16_t sensor,
+                                  struct sts3x_shm_sensor_info* info) {
+    if (sensor >= shm->header->num_sensors)
+        return STATUS_ERR_BAD_DATA;
+    *info = shm->sensors[sensor];
+    return STATUS_OK;
+}
+
+int16_t sts3x_shm_read_latest(const struct sts3x_shm* shm, uint16_t sensor,
+                              struct sts3x_shm_reading* reading) {
+    const struct sts3x_shm_slot* slot;
+    uint64_t index;
+
+    if (sensor >= shm->header->num_sensors)
+        return STATUS_ERR_BAD_DATA;
+    slot = &shm->latest[sensor];
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) == 0)
+        return STATUS_ERR_BAD_DATA; /* never written */
+    return sts3x_shm_read_slot(slot, &index, reading);
+}
+
+uint32_t sts3x_shm_read(struct sts3x_shm* shm,
+                        struct sts3x_shm_reading* readings,
+                        uint32_t max_readings, uint64_t* lost) {
+    const struct sts3x_shm_header* header = shm->header;
+    uint64_t capacity = header->capacity;
+    uint64_t skipped = 0;
+    uint64_t index;
+    uint64_t head;
+    uint32_t count = 0;
+
+    while (count < max_readings) {
+        head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+        if (shm->cursor == head)
+            break;
+        if (head - shm->cursor > capacity) {
+            skipped += head - shm->cursor - capacity;
+            shm->cursor = head - capacity;
+        }
+        if (sts3x_shm_read_slot(&shm->ring[shm->cursor & (capacity - 1)],
+                                &index, &readings[count]) != STATUS_OK)
+            break;
+        if (index != shm->cursor) {
+            /* overwritten while it was copied, skip the lost readings */
+            skipped += index - capacity + 1 - shm->cursor;
+            shm->cursor = index - capacity + 1;
+            continue;
+        }
+        shm->cursor++;
+        count++;
+    }
+
+    if (lost)
+        *lost += skipped;
+    return count;
+}
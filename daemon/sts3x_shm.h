@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Shared memory ring of STS3x readings
+ *
+ * Layout of the POSIX shared memory object published by sts3x-daemon, and the
+ * functions to write (daemon) and read (clients) it. There is one writer and
+ * any number of readers. Readers never block the writer and do not need any
+ * system calls once the object is mapped: every record is guarded by a
+ * sequence counter (seqlock) and readers retry if the record changed while it
+ * was copied.
+ *
+ * The object contains the latest reading of every sensor and a ring of the
+ * most recent readings of all sensors. Readers which fall behind by more than
+ * the capacity of the ring lose the oldest readings and are told how many.
+ *
+ * Timestamps are taken from CLOCK_MONOTONIC and are thus comparable between
+ * processes on the same host.
+ */
+
+#ifndef STS3X_SHM_H
+#define STS3X_SHM_H
+
+#include "sensirion_arch_config.h"
+#include "sts3x.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STS3X_SHM_DEFAULT_NAME "/sts3x"
+#define STS3X_SHM_MAGIC 0x53545333 /* "STS3" */
+#define STS3X_SHM_VERSION 1
+
+/* attempts to copy a record while the writer keeps changing it */
+#define STS3X_SHM_READ_ATTEMPTS 1000
+
+/**
+ * A single reading of a sensor.
+ */
+struct sts3x_shm_reading {
+    uint64_t timestamp_usec; /* CLOCK_MONOTONIC at the read out */
+    int32_t temperature;     /* [degree Celsius], multiplied by 1000 */
+    int16_t status;          /* 0 if temperature is valid, else an error code */
+    uint16_t sensor;         /* index of the sensor */
+};
+
+/**
+ * Static description of a sensor, set by the daemon before it starts.
+ */
+struct sts3x_shm_sensor_info {
+    uint32_t serial;        /* serial number, 0 if it could not be read */
+    uint32_t interval_msec; /* sampling interval */
+    uint8_t address;        /* I2C address of the sensor */
+    uint8_t mux_address;    /* I2C multiplexer, 0 if not behind a mux */
+    uint8_t mux_channel;    /* multiplexer channel */
+    uint8_t reserved;
+};
+
+/* a record guarded by a sequence counter, odd while it is written */
+struct sts3x_shm_slot {
+    uint32_t sequence;
+    uint32_t reserved;
+    uint64_t index; /* position in the ring, see sts3x_shm_read() */
+    struct sts3x_shm_reading reading;
+};
+
+struct sts3x_shm_header {
+    uint32_t magic;   /* STS3X_SHM_MAGIC once the object is initialized */
+    uint16_t version; /* STS3X_SHM_VERSION */
+    uint16_t num_sensors;
+    uint32_t capacity; /* readings in the ring, a power of two */
+    uint32_t reserved;
+    uint64_t head; /* number of readings ever published */
+    /*
+     * followed by num_sensors struct sts3x_shm_sensor_info, num_sensors
+     * struct sts3x_shm_slot with the latest reading per sensor and capacity
+     * struct sts3x_shm_slot for the ring
+     */
+};
+
+/**
+ * Handle of a mapped shared memory object, one per process.
+ */
+struct sts3x_shm {
+    struct sts3x_shm_header* header;
+    struct sts3x_shm_sensor_info* sensors;
+    struct sts3x_shm_slot* latest;
+    struct sts3x_shm_slot* ring;
+    uint64_t cursor; /* next ring index to read, see sts3x_shm_read() */
+    size_t size;
+};
+
+/**
+ * Creates (or replaces) and maps a shared memory object. Used by the daemon.
+ * The object is not visible to readers until sts3x_shm_start() is called.
+ *
+ * @param shm           the handle to initialize
+ * @param name          the name of the object, e.g. STS3X_SHM_DEFAULT_NAME
+ * @param num_sensors   number of sensors, at least 1
+ * @param capacity      number of readings in the ring, rounded up to a power
+ *                      of two
+ * @return              0 on success, else an error code (errno is set)
+ */
+int16_t sts3x_shm_create(struct sts3x_shm* shm, const char* name,
+                         uint16_t num_sensors, uint32_t capacity);
+
+/**
+ * Sets the description of a sensor. Must be called before sts3x_shm_start().
+ *
+ * @param shm       the handle returned by sts3x_shm_create()
+ * @param sensor    the index of the sensor
+ * @param info      the description
+ */
+void sts3x_shm_set_sensor_info(struct sts3x_shm* shm, uint16_t sensor,
+                               const struct sts3x_shm_sensor_info* info);
+
+/**
+ * Makes the object visible to readers.
+ *
+ * @param shm   the handle returned by sts3x_shm_create()
+ */
+void sts3x_shm_start(struct sts3x_shm* shm);
+
+/**
+ * Publishes a reading: updates the latest reading of the sensor and appends it
+ * to the ring. Must only be called by one thread.
+ *
+ * @param shm       the handle returned by sts3x_shm_create()
+ * @param reading   the reading, reading->sensor selects the sensor
+ */
+void sts3x_shm_publish(struct sts3x_shm* shm,
+                       const struct sts3x_shm_reading* reading);
+
+/**
+ * Maps an existing shared memory object read-only. Used by clients. Reading
+ * from the ring with sts3x_shm_read() starts at the oldest reading.
+ *
+ * @param shm   the handle to initialize
+ * @param name  the name of the object, e.g. STS3X_SHM_DEFAULT_NAME
+ * @return      0 on success, STATUS_ERR_BAD_DATA if the object does not exist
+ *              (errno is set), is not initialized yet or has an unknown
+ *              version.
+ */
+int16_t sts3x_shm_open(struct sts3x_shm* shm, const char* name);
+
+/**
+ * Unmaps the object. The object itself is kept, see sts3x_shm_unlink().
+ *
+ * @param shm   the handle
+ */
+void sts3x_shm_close(struct sts3x_shm* shm);
+
+/**
+ * Removes a shared memory object. Readers which still have it mapped keep
+ * their (no longer updated) view.
+ *
+ * @param name  the name of the object
+ */
+void sts3x_shm_unlink(const char* name);
+
+/**
+ * Returns the number of sensors in the object.
+ *
+ * @param shm   the handle
+ * @return      the number of sensors
+ */
+uint16_t sts3x_shm_num_sensors(const struct sts3x_shm* shm);
+
+/**
+ * Returns the description of a sensor.
+ *
+ * @param shm       the handle
+ * @param sensor    the index of the sensor
+ * @param info      the address for the description
+ * @return          0 on success, STATUS_ERR_BAD_DATA if there is no such sensor
+ */
+int16_t sts3x_shm_get_sensor_info(const struct sts3x_shm* shm, uint16_t sensor,
+                                  struct sts3x_shm_sensor_info* info);
+
+/**
+ * Copies the latest reading of a sensor.
+ *
+ * @param shm       the handle
+ * @param sensor    the index of the sensor
+ * @param reading   the address for the reading
+ * @return          0 on success, STATUS_ERR_BAD_DATA if there is no such sensor
+ *                  or no reading yet, STATUS_IN_PROGRESS if the writer did not
+ *                  finish the update within STS3X_SHM_READ_ATTEMPTS attempts
+ *                  (e.g. because it was killed meanwhile).
+ */
+int16_t sts3x_shm_read_latest(const struct sts3x_shm* shm, uint16_t sensor,
+                              struct sts3x_shm_reading* reading);
+
+/**
+ * Copies the readings of all sensors published since the last call, oldest
+ * first. If the writer overwrote readings before they were copied, they are
+ * skipped and counted in lost.
+ *
+ * @param shm           the handle
+ * @param readings      the address for the readings
+ * @param max_readings  the number of elements in readings
+ * @param lost          incremented by the number of skipped readings, may be
+ *                      NULL
+ * @return              the number of copied readings
+ */
+uint32_t sts3x_shm_read(struct sts3x_shm* shm,
+                        struct sts3x_shm_reading* readings,
+                        uint32_t max_readings, uint64_t* lost);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STS3X_SHM_H */
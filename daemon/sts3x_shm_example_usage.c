@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Example client of sts3x-daemon: prints the latest reading of every sensor
+ * once per second. Reading the values does not access the I2C bus and does
+ * not need any system calls.
+ *
+ * Usage: sts3x_shm_example_usage [name]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>  // printf
+#include <unistd.h> // sleep
+
+#include "sts3x_shm.h"
+
+int main(int argc, char** argv) {
+    const char* name = argc > 1 ? argv[1] : STS3X_SHM_DEFAULT_NAME;
+    struct sts3x_shm_reading reading;
+    struct sts3x_shm shm;
+    uint16_t i;
+
+    while (sts3x_shm_open(&shm, name) != STATUS_OK) {
+        printf("waiting for sts3x-daemon\n");
+        sleep(1);
+    }
+
+    while (1) {
+        for (i = 0; i < sts3x_shm_num_sensors(&shm); ++i) {
+            if (sts3x_shm_read_latest(&shm, i, &reading) != STATUS_OK)
+                continue;
+            if (reading.status == STATUS_OK)
+                printf("sensor %u: %0.2f degreeCelsius\n", i,
+                       reading.temperature / 1000.0f);
+            else
+                printf("sensor %u: error %d\n", i, reading.status);
+        }
+        sleep(1);
+    }
+    return 0;
+}
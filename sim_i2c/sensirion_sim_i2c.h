@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Simulated I2C bus with STS3x sensors
+ *
+ * Host side implementation of the I2C HAL (sensirion_i2c.h) which emulates
+ * STS3x sensors instead of accessing hardware. Select it with
+ * CONFIG_I2C_TYPE = sim_i2c to run the driver, the tests and benchmarks on a
+ * plain host without sensors.
+ *
+ * The simulation runs on a virtual clock: sensirion_sleep_usec() and every
+ * transaction advance the clock instead of waiting, so measurement timings are
+ * modeled exactly but run as fast as possible. Reading a measurement before
+ * the conversion is complete is not acknowledged, just like on the real
+ * sensor.
+ *
+ * By default, the bus contains one STS3x at 0x4A on channel 0 of an I2C
+ * multiplexer at 0x72, like the hardware test setup.
+ */
+
+#ifndef SENSIRION_SIM_I2C_H
+#define SENSIRION_SIM_I2C_H
+
+#include "sensirion_arch_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSIRION_SIM_I2C_MAX_DEVICES 16
+#define SENSIRION_SIM_I2C_NO_MUX 0xFF
+#define SENSIRION_SIM_I2C_DEFAULT_MUX_ADDRESS 0x72
+
+/* error code returned by the HAL functions if a transaction is not acked */
+#define SENSIRION_SIM_I2C_NACK (-1)
+
+/* the next transactions with a sensor are not acknowledged */
+#define SENSIRION_SIM_I2C_FAULT_NACK 0
+/* the next responses of a sensor have a wrong CRC */
+#define SENSIRION_SIM_I2C_FAULT_CRC 1
+/* SDA is held low, all transactions fail until sensirion_sim_i2c_bus_clear() */
+#define SENSIRION_SIM_I2C_FAULT_STUCK_BUS 2
+
+/**
+ * Bus activity counters, see sensirion_sim_i2c_get_stats().
+ */
+struct sensirion_sim_i2c_stats {
+    uint32_t transactions;  /* read and write transactions incl. NACKed */
+    uint32_t bytes_written; /* payload bytes written */
+    uint32_t bytes_read;    /* payload bytes read */
+    uint32_t nacks;         /* transactions which were not acknowledged */
+    uint32_t sleeps;        /* calls to sensirion_sleep_usec() */
+    uint64_t slept_usec;    /* total time passed to sensirion_sleep_usec() */
+    uint64_t bus_usec;      /* total time the bus was busy */
+};
+
+/**
+ * Temperature source of a simulated sensor.
+ *
+ * @param now_usec  the virtual time of the measurement
+ * @param context   the context passed to sensirion_sim_i2c_set_temperature_fn()
+ * @return          the temperature in milli degree Celsius
+ */
+typedef int32_t (*sensirion_sim_i2c_temperature_fn)(uint64_t now_usec,
+                                                    void* context);
+
+/**
+ * Called before and after every call of the I2C HAL and of
+ * sensirion_sleep_usec(), e.g. to check which thread uses the bus.
+ *
+ * @param enter     1 before the call, 0 after it
+ * @param context   the context passed to sensirion_sim_i2c_set_call_hook()
+ */
+typedef void (*sensirion_sim_i2c_call_hook_fn)(uint8_t enter, void* context);
+
+/**
+ * Point of a recorded temperature trace.
+ */
+struct sensirion_sim_i2c_trace_point {
+    uint32_t time_msec;  /* relative to the start of the trace */
+    int32_t temperature; /* milli degree Celsius */
+};
+
+/**
+ * Recorded temperature trace, see sensirion_sim_i2c_trace_temperature().
+ */
+struct sensirion_sim_i2c_trace {
+    const struct sensirion_sim_i2c_trace_point* points; /* ascending time */
+    uint16_t count;      /* number of points, at least 1 */
+    uint64_t start_usec; /* virtual time of the start of the trace */
+};
+
+/**
+ * Restores the default setup: one STS3x at 0x4A on channel 0 of a multiplexer
+ * at 0x72 measuring 25 degree Celsius, no faults, cleared statistics. The
+ * virtual clock is not reset.
+ */
+void sensirion_sim_i2c_reset(void);
+
+/**
+ * Removes all simulated sensors from the bus.
+ */
+void sensirion_sim_i2c_remove_devices(void);
+
+/**
+ * Adds a simulated STS3x to the bus. The sensor starts in the power up state.
+ *
+ * @param address       the I2C address of the sensor
+ * @param mux_channel   the multiplexer channel, or SENSIRION_SIM_I2C_NO_MUX if
+ *                      the sensor is directly attached to the bus
+ * @param serial        the serial number of the sensor
+ * @return              the index of the sensor, or -1 if the maximum number of
+ *                      sensors is reached
+ */
+int16_t sensirion_sim_i2c_add_sts3x(uint8_t address, uint8_t mux_channel,
+                                    uint32_t serial);
+
+/**
+ * Sets a constant temperature for a simulated sensor.
+ *
+ * @param device                    the index of the sensor
+ * @param temperature_milli_celsius the temperature in milli degree Celsius
+ */
+void sensirion_sim_i2c_set_temperature(int16_t device,
+                                       int32_t temperature_milli_celsius);
+
+/**
+ * Sets a time dependent temperature for a simulated sensor, e.g. to replay a
+ * recorded trace.
+ *
+ * @param device    the index of the sensor
+ * @param fn        the temperature source
+ * @param context   passed to fn
+ */
+void sensirion_sim_i2c_set_temperature_fn(int16_t device,
+                                          sensirion_sim_i2c_temperature_fn fn,
+                                          void* context);
+
+/**
+ * Temperature source which replays a recorded trace, to be set with
+ * sensirion_sim_i2c_set_temperature_fn() with a struct sensirion_sim_i2c_trace
+ * as context. The temperature is interpolated linearly between the points of
+ * the trace and constant before the first and after the last point.
+ *
+ * @param now_usec  the virtual time of the measurement
+ * @param trace     the trace, a struct sensirion_sim_i2c_trace
+ * @return          the temperature in milli degree Celsius
+ */
+int32_t sensirion_sim_i2c_trace_temperature(uint64_t now_usec, void* trace);
+
+/**
+ * Sets the temperature increase caused by the heater of a simulated sensor
+ * once it is fully heated up (default 3 degree Celsius within 1 second).
+ *
+ * @param device        the index of the sensor
+ * @param delta         the temperature increase in milli degree Celsius
+ * @param rise_usec     the time until the full increase is reached
+ */
+void sensirion_sim_i2c_set_heater(int16_t device, int32_t delta,
+                                  uint32_t rise_usec);
+
+/**
+ * Returns the state of the ALERT pin of a simulated sensor. Like on the real
+ * sensor, the pin is only driven in periodic measurement mode.
+ *
+ * @param device    the index of the sensor
+ * @return          1 if the alert is active, else 0
+ */
+uint8_t sensirion_sim_i2c_get_alert(int16_t device);
+
+/**
+ * Sets the address of the simulated I2C multiplexer.
+ *
+ * @param address   the I2C address of the multiplexer
+ */
+void sensirion_sim_i2c_set_mux_address(uint8_t address);
+
+/**
+ * Sets the simulated bus clock, used to model the duration of transactions
+ * (default 100kHz).
+ *
+ * @param frequency_hz  the bus clock in Hz
+ */
+void sensirion_sim_i2c_set_bus_frequency(uint32_t frequency_hz);
+
+/**
+ * Injects a fault into the next transactions with the simulated sensors.
+ *
+ * @param fault     one of SENSIRION_SIM_I2C_FAULT_*
+ * @param count     the number of affected transactions, ignored for
+ *                  SENSIRION_SIM_I2C_FAULT_STUCK_BUS
+ */
+void sensirion_sim_i2c_inject_fault(uint8_t fault, uint16_t count);
+
+/**
+ * Removes all injected faults.
+ */
+void sensirion_sim_i2c_clear_faults(void);
+
+/**
+ * Clears a stuck bus, i.e. the effect of toggling SCL until SDA is released.
+ */
+void sensirion_sim_i2c_bus_clear(void);
+
+/**
+ * Returns the virtual time.
+ *
+ * @return the virtual time in microseconds
+ */
+uint64_t sensirion_sim_i2c_now_usec(void);
+
+/**
+ * Returns the lower 32 bit of the virtual time, compatible with
+ * sts3x_clock_usec_fn.
+ *
+ * @return the virtual time in microseconds
+ */
+uint32_t sensirion_sim_i2c_clock_usec(void);
+
+/**
+ * Advances the virtual time without counting it as sleep.
+ *
+ * @param useconds  the time to advance in microseconds
+ */
+void sensirion_sim_i2c_advance_usec(uint32_t useconds);
+
+/**
+ * Sets a hook which is called around every call of the I2C HAL and of
+ * sensirion_sleep_usec(). sensirion_sim_i2c_reset() removes the hook.
+ *
+ * @param hook      the hook, NULL to remove it
+ * @param context   passed to the hook
+ */
+void sensirion_sim_i2c_set_call_hook(sensirion_sim_i2c_call_hook_fn hook,
+                                     void* context);
+
+/**
+ * Copies the bus activity counters.
+ *
+ * @param stats the address for the counters
+ */
+void sensirion_sim_i2c_get_stats(struct sensirion_sim_i2c_stats* stats);
+
+/**
+ * Resets the bus activity counters.
+ */
+void sensirion_sim_i2c_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSIRION_SIM_I2C_H */
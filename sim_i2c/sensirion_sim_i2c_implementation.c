@@ -0,0 +1,811 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Simulated I2C bus with STS3x sensors, implementation
+ *
+ * Implements the I2C HAL of sensirion_i2c.h on top of emulated STS3x sensors
+ * and a virtual clock. See sensirion_sim_i2c.h.
+ */
+
+#include "sensirion_sim_i2c.h"
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sensirion_i2c_transfer.h"
+
+#define SIM_STS3X_STATUS_ALERT_PENDING 0x8000
+#define SIM_STS3X_STATUS_HEATER_ON 0x2000
+#define SIM_STS3X_STATUS_T_ALERT 0x0400
+#define SIM_STS3X_STATUS_RESET_DETECTED 0x0010
+#define SIM_STS3X_STATUS_COMMAND_FAILED 0x0002
+#define SIM_STS3X_STATUS_WRITE_CRC_FAILED 0x0001
+#define SIM_STS3X_STATUS_POWER_UP \
+    (SIM_STS3X_STATUS_ALERT_PENDING | SIM_STS3X_STATUS_RESET_DETECTED)
+#define SIM_STS3X_STATUS_CLEARABLE                                 \
+    (SIM_STS3X_STATUS_ALERT_PENDING | SIM_STS3X_STATUS_T_ALERT |   \
+     SIM_STS3X_STATUS_RESET_DETECTED)
+
+#define SIM_STS3X_CMD_BREAK 0x3093
+#define SIM_STS3X_CMD_SOFT_RESET 0x30A2
+#define SIM_STS3X_CMD_HEATER_ON 0x306D
+#define SIM_STS3X_CMD_HEATER_OFF 0x3066
+#define SIM_STS3X_CMD_READ_STATUS_REG 0xF32D
+#define SIM_STS3X_CMD_CLEAR_STATUS_REG 0x3041
+#define SIM_STS3X_CMD_READ_SERIAL_ID 0x3780
+#define SIM_STS3X_CMD_FETCH_DATA 0xE000
+/* periodic mode with accelerated response time, 4 measurements per second */
+#define SIM_STS3X_CMD_ART 0x2B32
+/* alert limits: 7 bit humidity (ignored) and 9 bit temperature */
+#define SIM_STS3X_ALERT_LIMIT_TEMPERATURE_MASK 0x01FF
+#define SIM_STS3X_ALERT_LIMIT_HIGH_SET 0
+#define SIM_STS3X_ALERT_LIMIT_HIGH_CLEAR 1
+#define SIM_STS3X_ALERT_LIMIT_LOW_CLEAR 2
+#define SIM_STS3X_ALERT_LIMIT_LOW_SET 3
+/* alert state is evaluated for at most this many past periodic measurements */
+#define SIM_STS3X_ALERT_MAX_BACKLOG 64
+
+#define SIM_GENERAL_CALL_ADDRESS 0x00
+#define SIM_GENERAL_CALL_RESET 0x06
+
+/* time the sensor does not respond after a reset or break command */
+static const uint32_t SIM_STS3X_RESET_USEC = 1000;
+static const uint32_t SIM_STS3X_BREAK_USEC = 1000;
+static const int32_t SIM_STS3X_DEFAULT_TEMPERATURE = 25000;
+static const int32_t SIM_STS3X_DEFAULT_HEATER_DELTA = 3000;
+static const uint32_t SIM_STS3X_DEFAULT_HEATER_RISE_USEC = 1000000;
+static const uint32_t SIM_DEFAULT_BUS_FREQUENCY_HZ = 100000;
+
+/* single shot commands without and with clock stretching */
+static const uint16_t SIM_STS3X_CMD_MEASURE[] = {0x2400, 0x240B, 0x2416};
+static const uint16_t SIM_STS3X_CMD_MEASURE_CS[] = {0x2C06, 0x2C0D, 0x2C10};
+/* conversion time of the simulated sensors (datasheet typical values) */
+static const uint32_t SIM_STS3X_DURATION_USEC[] = {12500, 4500, 2500};
+/* periodic measurement commands, indexed by rate and then by repeatability */
+static const uint16_t SIM_STS3X_CMD_PERIODIC[][3] = {
+    {0x2032, 0x2024, 0x202F}, {0x2130, 0x2126, 0x212D},
+    {0x2236, 0x2220, 0x222B}, {0x2334, 0x2322, 0x2329},
+    {0x2737, 0x2721, 0x272A},
+};
+static const uint32_t SIM_STS3X_PERIODIC_INTERVAL_USEC[] = {
+    2000000, 1000000, 500000, 250000, 100000,
+};
+static const uint32_t SIM_STS3X_ART_INTERVAL_USEC = 250000;
+/* alert limit commands, indexed by SIM_STS3X_ALERT_LIMIT_* */
+static const uint16_t SIM_STS3X_CMD_READ_ALERT_LIMIT[] = {0xE11F, 0xE114,
+                                                          0xE109, 0xE102};
+static const uint16_t SIM_STS3X_CMD_WRITE_ALERT_LIMIT[] = {0x611D, 0x6116,
+                                                           0x610B, 0x6100};
+/* alert limits after power up: 60, 58, -9 and -10 degree Celsius */
+static const uint16_t SIM_STS3X_DEFAULT_ALERT_LIMIT[] = {0xFF33, 0xFF2D, 0x0069,
+                                                         0x0066};
+
+struct sim_sts3x {
+    uint8_t in_use;
+    uint8_t address;
+    uint8_t mux_channel;
+    uint32_t serial;
+    int32_t temperature;
+    sensirion_sim_i2c_temperature_fn temperature_fn;
+    void* temperature_context;
+    int32_t heater_delta;
+    uint32_t heater_rise_usec;
+    uint8_t heater_on;
+    uint64_t heater_on_since;
+    uint16_t status;
+    /* sensor does not acknowledge its address until busy_until */
+    uint64_t busy_until;
+    /* response to the last command, available at busy_until */
+    uint16_t response[2];
+    uint8_t response_words;
+    uint8_t clock_stretching;
+    /* periodic measurement mode */
+    uint8_t periodic;
+    uint64_t periodic_start;
+    uint32_t periodic_interval;
+    uint32_t periodic_duration;
+    uint32_t periodic_fetched;
+    /* alert mode */
+    uint16_t alert_limits[4];
+    uint32_t alert_evaluated;
+    uint8_t alert_high;
+    uint8_t alert_low;
+};
+
+static struct sim_sts3x sim_devices[SENSIRION_SIM_I2C_MAX_DEVICES];
+static uint8_t sim_initialized;
+static uint8_t sim_mux_address;
+static uint8_t sim_mux_channels;
+static uint32_t sim_bus_frequency_hz;
+static uint64_t sim_now;
+static uint16_t sim_fault_nack;
+static uint16_t sim_fault_crc;
+static uint8_t sim_bus_stuck;
+static struct sensirion_sim_i2c_stats sim_stats;
+static sensirion_sim_i2c_call_hook_fn sim_call_hook;
+static void* sim_call_hook_context;
+
+static void sim_init(void) {
+    if (!sim_initialized)
+        sensirion_sim_i2c_reset();
+}
+
+static void sim_sts3x_power_up(struct sim_sts3x* dev) {
+    uint8_t i;
+
+    dev->heater_on = 0;
+    dev->status = SIM_STS3X_STATUS_POWER_UP;
+    dev->busy_until = sim_now + SIM_STS3X_RESET_USEC;
+    dev->response_words = 0;
+    dev->periodic = 0;
+    for (i = 0; i < 4; ++i)
+        dev->alert_limits[i] = SIM_STS3X_DEFAULT_ALERT_LIMIT[i];
+    dev->alert_high = 0;
+    dev->alert_low = 0;
+}
+
+static int32_t sim_sts3x_temperature(const struct sim_sts3x* dev,
+                                     uint64_t at) {
+    int32_t temperature = dev->temperature;
+    uint64_t heated;
+
+    if (dev->temperature_fn)
+        temperature = dev->temperature_fn(at, dev->temperature_context);
+
+    if (dev->heater_on) {
+        heated = at - dev->heater_on_since;
+        if (heated >= dev->heater_rise_usec)
+            temperature += dev->heater_delta;
+        else
+            temperature += (int32_t)((int64_t)dev->heater_delta *
+                                     (int64_t)heated / dev->heater_rise_usec);
+    }
+    return temperature;
+}
+
+static uint16_t sim_sts3x_ticks(const struct sim_sts3x* dev, uint64_t at) {
+    /* inverse of T = 175 * S_T / 2^16 - 45, rounded */
+    int64_t ticks =
+        ((int64_t)(sim_sts3x_temperature(dev, at) + 45000) * 65536 + 87500) /
+        175000;
+
+    if (ticks < 0)
+        return 0;
+    if (ticks > 0xFFFF)
+        return 0xFFFF;
+    return (uint16_t)ticks;
+}
+
+/* whether the sensor is connected to the bus, i.e. not behind a closed mux
+ * channel */
+static uint8_t sim_device_selected(const struct sim_sts3x* dev) {
+    return dev->in_use && (dev->mux_channel == SENSIRION_SIM_I2C_NO_MUX ||
+                           (sim_mux_channels & (1 << dev->mux_channel)));
+}
+
+static struct sim_sts3x* sim_find_device(uint8_t address) {
+    struct sim_sts3x* dev;
+    uint8_t i;
+
+    for (i = 0; i < SENSIRION_SIM_I2C_MAX_DEVICES; ++i) {
+        dev = &sim_devices[i];
+        if (sim_device_selected(dev) && dev->address == address)
+            return dev;
+    }
+    return NULL;
+}
+
+static void sim_transaction(uint16_t count) {
+    /* start, address byte, payload bytes (each with ack bit) and stop */
+    uint64_t bits = (uint64_t)(count + 1) * 9 + 2;
+    uint64_t usec = (bits * 1000000 + sim_bus_frequency_hz - 1) /
+                    sim_bus_frequency_hz;
+
+    sim_stats.transactions++;
+    sim_stats.bus_usec += usec;
+    sim_now += usec;
+}
+
+static int8_t sim_nack(void) {
+    sim_stats.nacks++;
+    return SENSIRION_SIM_I2C_NACK;
+}
+
+static void sim_sts3x_start_periodic_mode(struct sim_sts3x* dev,
+                                          uint32_t interval,
+                                          uint32_t duration) {
+    dev->periodic = 1;
+    dev->periodic_start = sim_now;
+    dev->periodic_interval = interval;
+    dev->periodic_duration = duration;
+    dev->periodic_fetched = 0;
+    dev->alert_evaluated = 0;
+}
+
+static int8_t sim_sts3x_start_periodic(struct sim_sts3x* dev, uint16_t cmd) {
+    uint8_t rate;
+    uint8_t repeatability;
+
+    if (cmd == SIM_STS3X_CMD_ART) {
+        sim_sts3x_start_periodic_mode(dev, SIM_STS3X_ART_INTERVAL_USEC,
+                                      SIM_STS3X_DURATION_USEC[0]);
+        return 1;
+    }
+
+    for (rate = 0; rate < 5; ++rate) {
+        for (repeatability = 0; repeatability < 3; ++repeatability) {
+            if (SIM_STS3X_CMD_PERIODIC[rate][repeatability] == cmd) {
+                sim_sts3x_start_periodic_mode(
+                    dev, SIM_STS3X_PERIODIC_INTERVAL_USEC[rate],
+                    SIM_STS3X_DURATION_USEC[repeatability]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static uint32_t sim_sts3x_periodic_available(const struct sim_sts3x* dev) {
+    uint64_t elapsed = sim_now - dev->periodic_start;
+
+    if (elapsed < dev->periodic_duration)
+        return 0;
+    return (uint32_t)((elapsed - dev->periodic_duration) /
+                      dev->periodic_interval) +
+           1;
+}
+
+static uint64_t sim_sts3x_periodic_time(const struct sim_sts3x* dev,
+                                        uint32_t measurement) {
+    return dev->periodic_start + dev->periodic_duration +
+           (uint64_t)(measurement - 1) * dev->periodic_interval;
+}
+
+static uint16_t sim_sts3x_alert_ticks(const struct sim_sts3x* dev,
+                                      uint8_t limit) {
+    return (uint16_t)((dev->alert_limits[limit] &
+                       SIM_STS3X_ALERT_LIMIT_TEMPERATURE_MASK)
+                      << 7);
+}
+
+/* compares the periodic measurements since the last call with the limits */
+static void sim_sts3x_update_alert(struct sim_sts3x* dev) {
+    uint32_t available;
+    uint32_t i;
+    uint16_t ticks;
+
+    if (!dev->periodic)
+        return;
+
+    available = sim_sts3x_periodic_available(dev);
+    i = dev->alert_evaluated;
+    if (available - i > SIM_STS3X_ALERT_MAX_BACKLOG)
+        i = available - SIM_STS3X_ALERT_MAX_BACKLOG;
+    for (++i; i <= available; ++i) {
+        ticks = sim_sts3x_ticks(dev, sim_sts3x_periodic_time(dev, i));
+        if (ticks > sim_sts3x_alert_ticks(dev, SIM_STS3X_ALERT_LIMIT_HIGH_SET))
+            dev->alert_high = 1;
+        else if (ticks <
+                 sim_sts3x_alert_ticks(dev, SIM_STS3X_ALERT_LIMIT_HIGH_CLEAR))
+            dev->alert_high = 0;
+        if (ticks < sim_sts3x_alert_ticks(dev, SIM_STS3X_ALERT_LIMIT_LOW_SET))
+            dev->alert_low = 1;
+        else if (ticks >
+                 sim_sts3x_alert_ticks(dev, SIM_STS3X_ALERT_LIMIT_LOW_CLEAR))
+            dev->alert_low = 0;
+        if (dev->alert_high || dev->alert_low)
+            dev->status |=
+                SIM_STS3X_STATUS_ALERT_PENDING | SIM_STS3X_STATUS_T_ALERT;
+    }
+    dev->alert_evaluated = available;
+}
+
+static void sim_sts3x_write_alert_limit(struct sim_sts3x* dev, uint8_t limit,
+                                        const uint8_t* args,
+                                        uint16_t num_args) {
+    if (num_args != SENSIRION_WORD_SIZE + CRC8_LEN ||
+        sensirion_common_generate_crc(args, SENSIRION_WORD_SIZE) !=
+            args[SENSIRION_WORD_SIZE]) {
+        dev->status |= SIM_STS3X_STATUS_WRITE_CRC_FAILED;
+        return;
+    }
+    dev->status &= (uint16_t)~SIM_STS3X_STATUS_WRITE_CRC_FAILED;
+    dev->alert_limits[limit] = (uint16_t)((uint16_t)args[0] << 8 | args[1]);
+}
+
+static void sim_sts3x_fetch(struct sim_sts3x* dev) {
+    uint32_t available = sim_sts3x_periodic_available(dev);
+
+    if (available <= dev->periodic_fetched)
+        return; /* no new data, the read is not acknowledged */
+
+    dev->periodic_fetched = available;
+    dev->response[0] =
+        sim_sts3x_ticks(dev, sim_sts3x_periodic_time(dev, available));
+    dev->response_words = 1;
+}
+
+static void sim_sts3x_command(struct sim_sts3x* dev, uint16_t cmd,
+                              const uint8_t* args, uint16_t num_args) {
+    uint8_t i;
+
+    sim_sts3x_update_alert(dev);
+    dev->response_words = 0;
+    dev->clock_stretching = 0;
+
+    for (i = 0; i < 4; ++i) {
+        if (cmd == SIM_STS3X_CMD_READ_ALERT_LIMIT[i]) {
+            dev->response[0] = dev->alert_limits[i];
+            dev->response_words = 1;
+            return;
+        }
+        if (cmd == SIM_STS3X_CMD_WRITE_ALERT_LIMIT[i]) {
+            sim_sts3x_write_alert_limit(dev, i, args, num_args);
+            return;
+        }
+    }
+
+    for (i = 0; i < 3; ++i) {
+        if (cmd == SIM_STS3X_CMD_MEASURE[i] ||
+            cmd == SIM_STS3X_CMD_MEASURE_CS[i]) {
+            if (dev->periodic)
+                break; /* not processed in periodic mode */
+            dev->busy_until = sim_now + SIM_STS3X_DURATION_USEC[i];
+            dev->response[0] = sim_sts3x_ticks(dev, dev->busy_until);
+            dev->response_words = 1;
+            dev->clock_stretching = cmd == SIM_STS3X_CMD_MEASURE_CS[i];
+            return;
+        }
+    }
+
+    switch (cmd) {
+        case SIM_STS3X_CMD_FETCH_DATA:
+            if (dev->periodic)
+                sim_sts3x_fetch(dev);
+            return;
+        case SIM_STS3X_CMD_BREAK:
+            dev->periodic = 0;
+            dev->busy_until = sim_now + SIM_STS3X_BREAK_USEC;
+            return;
+        case SIM_STS3X_CMD_SOFT_RESET:
+            sim_sts3x_power_up(dev);
+            return;
+        case SIM_STS3X_CMD_HEATER_ON:
+            if (!dev->heater_on)
+                dev->heater_on_since = sim_now;
+            dev->heater_on = 1;
+            dev->status |= SIM_STS3X_STATUS_HEATER_ON;
+            return;
+        case SIM_STS3X_CMD_HEATER_OFF:
+            dev->heater_on = 0;
+            dev->status &= (uint16_t)~SIM_STS3X_STATUS_HEATER_ON;
+            return;
+        case SIM_STS3X_CMD_READ_STATUS_REG:
+            dev->response[0] = dev->status;
+            dev->response_words = 1;
+            return;
+        case SIM_STS3X_CMD_CLEAR_STATUS_REG:
+            dev->status &= (uint16_t)~SIM_STS3X_STATUS_CLEARABLE;
+            return;
+        case SIM_STS3X_CMD_READ_SERIAL_ID:
+            dev->response[0] = (uint16_t)(dev->serial >> 16);
+            dev->response[1] = (uint16_t)dev->serial;
+            dev->response_words = 2;
+            return;
+        default:
+            break;
+    }
+
+    if (!dev->periodic && sim_sts3x_start_periodic(dev, cmd))
+        return;
+
+    dev->status |= SIM_STS3X_STATUS_COMMAND_FAILED;
+}
+
+void sensirion_sim_i2c_reset(void) {
+    sim_initialized = 1;
+    sim_mux_address = SENSIRION_SIM_I2C_DEFAULT_MUX_ADDRESS;
+    sim_mux_channels = 0;
+    sim_bus_frequency_hz = SIM_DEFAULT_BUS_FREQUENCY_HZ;
+    sensirion_sim_i2c_clear_faults();
+    sensirion_sim_i2c_reset_stats();
+    sensirion_sim_i2c_set_call_hook(NULL, NULL);
+    sensirion_sim_i2c_remove_devices();
+    sensirion_sim_i2c_add_sts3x(0x4A, 0, 0x12345678);
+}
+
+void sensirion_sim_i2c_remove_devices(void) {
+    uint8_t i;
+
+    sim_initialized = 1;
+    for (i = 0; i < SENSIRION_SIM_I2C_MAX_DEVICES; ++i)
+        sim_devices[i].in_use = 0;
+}
+
+int16_t sensirion_sim_i2c_add_sts3x(uint8_t address, uint8_t mux_channel,
+                                    uint32_t serial) {
+    struct sim_sts3x* dev;
+    int16_t i;
+
+    sim_init();
+    for (i = 0; i < SENSIRION_SIM_I2C_MAX_DEVICES; ++i) {
+        dev = &sim_devices[i];
+        if (dev->in_use)
+            continue;
+
+        dev->in_use = 1;
+        dev->address = address;
+        dev->mux_channel = mux_channel;
+        dev->serial = serial;
+        dev->temperature = SIM_STS3X_DEFAULT_TEMPERATURE;
+        dev->temperature_fn = NULL;
+        dev->temperature_context = NULL;
+        dev->heater_delta = SIM_STS3X_DEFAULT_HEATER_DELTA;
+        dev->heater_rise_usec = SIM_STS3X_DEFAULT_HEATER_RISE_USEC;
+        sim_sts3x_power_up(dev);
+        dev->busy_until = 0;
+        return i;
+    }
+    return -1;
+}
+
+void sensirion_sim_i2c_set_temperature(int16_t device,
+                                       int32_t temperature_milli_celsius) {
+    sim_devices[device].temperature = temperature_milli_celsius;
+    sim_devices[device].temperature_fn = NULL;
+}
+
+void sensirion_sim_i2c_set_temperature_fn(int16_t device,
+                                          sensirion_sim_i2c_temperature_fn fn,
+                                          void* context) {
+    sim_devices[device].temperature_fn = fn;
+    sim_devices[device].temperature_context = context;
+}
+
+int32_t sensirion_sim_i2c_trace_temperature(uint64_t now_usec, void* trace) {
+    const struct sensirion_sim_i2c_trace* t =
+        (const struct sensirion_sim_i2c_trace*)trace;
+    const struct sensirion_sim_i2c_trace_point* a;
+    const struct sensirion_sim_i2c_trace_point* b;
+    uint64_t time_msec;
+    uint16_t i;
+
+    if (now_usec < t->start_usec)
+        return t->points[0].temperature;
+    time_msec = (now_usec - t->start_usec) / 1000;
+    if (time_msec < t->points[0].time_msec)
+        return t->points[0].temperature;
+
+    for (i = 1; i < t->count; ++i) {
+        if (t->points[i].time_msec > time_msec) {
+            a = &t->points[i - 1];
+            b = &t->points[i];
+            return a->temperature +
+                   (int32_t)(((int64_t)b->temperature - a->temperature) *
+                             (int64_t)(time_msec - a->time_msec) /
+                             (int64_t)(b->time_msec - a->time_msec));
+        }
+    }
+    return t->points[t->count - 1].temperature;
+}
+
+void sensirion_sim_i2c_set_heater(int16_t device, int32_t delta,
+                                  uint32_t rise_usec) {
+    sim_devices[device].heater_delta = delta;
+    sim_devices[device].heater_rise_usec = rise_usec ? rise_usec : 1;
+}
+
+uint8_t sensirion_sim_i2c_get_alert(int16_t device) {
+    struct sim_sts3x* dev = &sim_devices[device];
+
+    sim_sts3x_update_alert(dev);
+    return dev->periodic && (dev->alert_high || dev->alert_low);
+}
+
+void sensirion_sim_i2c_set_mux_address(uint8_t address) {
+    sim_init();
+    sim_mux_address = address;
+}
+
+void sensirion_sim_i2c_set_bus_frequency(uint32_t frequency_hz) {
+    sim_init();
+    sim_bus_frequency_hz = frequency_hz;
+}
+
+void sensirion_sim_i2c_inject_fault(uint8_t fault, uint16_t count) {
+    sim_init();
+    switch (fault) {
+        case SENSIRION_SIM_I2C_FAULT_NACK:
+            sim_fault_nack = count;
+            break;
+        case SENSIRION_SIM_I2C_FAULT_CRC:
+            sim_fault_crc = count;
+            break;
+        case SENSIRION_SIM_I2C_FAULT_STUCK_BUS:
+            sim_bus_stuck = 1;
+            break;
+        default:
+            break;
+    }
+}
+
+void sensirion_sim_i2c_clear_faults(void) {
+    sim_fault_nack = 0;
+    sim_fault_crc = 0;
+    sim_bus_stuck = 0;
+}
+
+void sensirion_sim_i2c_bus_clear(void) {
+    /* nine clock pulses on SCL */
+    sim_now += 9 * 1000000 / sim_bus_frequency_hz;
+    sim_bus_stuck = 0;
+}
+
+uint64_t sensirion_sim_i2c_now_usec(void) {
+    return sim_now;
+}
+
+uint32_t sensirion_sim_i2c_clock_usec(void) {
+    return (uint32_t)sim_now;
+}
+
+void sensirion_sim_i2c_advance_usec(uint32_t useconds) {
+    sim_now += useconds;
+}
+
+void sensirion_sim_i2c_set_call_hook(sensirion_sim_i2c_call_hook_fn hook,
+                                     void* context) {
+    sim_call_hook = hook;
+    sim_call_hook_context = context;
+}
+
+void sensirion_sim_i2c_get_stats(struct sensirion_sim_i2c_stats* stats) {
+    *stats = sim_stats;
+}
+
+void sensirion_sim_i2c_reset_stats(void) {
+    sim_stats.transactions = 0;
+    sim_stats.bytes_written = 0;
+    sim_stats.bytes_read = 0;
+    sim_stats.nacks = 0;
+    sim_stats.sleeps = 0;
+    sim_stats.slept_usec = 0;
+    sim_stats.bus_usec = 0;
+}
+
+static void sim_call_begin(void) {
+    if (sim_call_hook)
+        sim_call_hook(1, sim_call_hook_context);
+}
+
+static void sim_call_end(void) {
+    if (sim_call_hook)
+        sim_call_hook(0, sim_call_hook_context);
+}
+
+static void sim_sleep(uint32_t useconds) {
+    sim_stats.sleeps++;
+    sim_stats.slept_usec += useconds;
+    sim_now += useconds;
+}
+
+/* I2C HAL, see sensirion_i2c.h */
+
+int16_t sensirion_i2c_select_bus(uint8_t bus_idx) {
+    /* the simulation has a single bus */
+    return bus_idx == 0 ? NO_ERROR : SENSIRION_SIM_I2C_NACK;
+}
+
+void sensirion_i2c_init(void) {
+    sim_init();
+}
+
+void sensirion_i2c_release(void) {
+}
+
+static int8_t sim_read(uint8_t address, uint8_t* data, uint16_t count) {
+    struct sim_sts3x* dev;
+    uint16_t word;
+    uint16_t i;
+
+    if (sim_bus_stuck)
+        return sim_nack();
+
+    if (address == sim_mux_address) {
+        for (i = 0; i < count; ++i)
+            data[i] = sim_mux_channels;
+        sim_stats.bytes_read += count;
+        return NO_ERROR;
+    }
+
+    dev = sim_find_device(address);
+    if (!dev)
+        return sim_nack();
+
+    if (sim_fault_nack) {
+        sim_fault_nack--;
+        return sim_nack();
+    }
+
+    if (sim_now < dev->busy_until) {
+        if (!dev->clock_stretching || !dev->response_words)
+            return sim_nack();
+        /* the sensor holds SCL low until the measurement is done */
+        sim_stats.bus_usec += dev->busy_until - sim_now;
+        sim_now = dev->busy_until;
+    }
+
+    if (!dev->response_words)
+        return sim_nack();
+
+    for (i = 0; i < count; ++i) {
+        if (i / 3 >= dev->response_words) {
+            data[i] = 0xFF;
+        } else if (i % 3 == 2) {
+            data[i] = sensirion_common_generate_crc(&data[i - 2], 2);
+            if (sim_fault_crc && i == 2)
+                data[i] ^= 0xFF;
+        } else {
+            word = dev->response[i / 3];
+            data[i] = (uint8_t)(i % 3 == 0 ? word >> 8 : word);
+        }
+    }
+    if (sim_fault_crc)
+        sim_fault_crc--;
+
+    dev->response_words = 0;
+    sim_stats.bytes_read += count;
+    return NO_ERROR;
+}
+
+static int8_t sim_write(uint8_t address, const uint8_t* data,
+                        uint16_t count) {
+    struct sim_sts3x* dev;
+    uint8_t i;
+
+    if (sim_bus_stuck)
+        return sim_nack();
+
+    if (address == SIM_GENERAL_CALL_ADDRESS) {
+        /* only reaches the sensors on the selected mux channels */
+        if (count == 1 && data[0] == SIM_GENERAL_CALL_RESET) {
+            for (i = 0; i < SENSIRION_SIM_I2C_MAX_DEVICES; ++i)
+                if (sim_device_selected(&sim_devices[i]))
+                    sim_sts3x_power_up(&sim_devices[i]);
+        }
+        sim_stats.bytes_written += count;
+        return NO_ERROR;
+    }
+
+    if (address == sim_mux_address) {
+        if (count)
+            sim_mux_channels = data[count - 1];
+        sim_stats.bytes_written += count;
+        return NO_ERROR;
+    }
+
+    dev = sim_find_device(address);
+    if (!dev)
+        return sim_nack();
+
+    if (sim_fault_nack) {
+        sim_fault_nack--;
+        return sim_nack();
+    }
+
+    if (sim_now < dev->busy_until)
+        return sim_nack();
+
+    sim_stats.bytes_written += count;
+    if (count < SENSIRION_COMMAND_SIZE)
+        return NO_ERROR; /* address only, e.g. a presence check */
+
+    sim_sts3x_command(dev, (uint16_t)((uint16_t)data[0] << 8 | data[1]),
+                      &data[SENSIRION_COMMAND_SIZE],
+                      (uint16_t)(count - SENSIRION_COMMAND_SIZE));
+    return NO_ERROR;
+}
+
+int8_t sensirion_i2c_read(uint8_t address, uint8_t* data, uint16_t count) {
+    int8_t ret;
+
+    sim_init();
+    sim_call_begin();
+    sim_transaction(count);
+    ret = sim_read(address, data, count);
+    sim_call_end();
+    return ret;
+}
+
+int8_t sensirion_i2c_write(uint8_t address, const uint8_t* data,
+                           uint16_t count) {
+    int8_t ret;
+
+    sim_init();
+    sim_call_begin();
+    sim_transaction(count);
+    ret = sim_write(address, data, count);
+    sim_call_end();
+    return ret;
+}
+
+static int8_t sim_transfer(const struct sensirion_i2c_transfer* transfer) {
+    int8_t ret;
+
+    if (transfer->delay_usec || !transfer->write_count ||
+        !transfer->read_count) {
+        /* separate transactions */
+        ret = NO_ERROR;
+        if (transfer->write_count) {
+            sim_transaction(transfer->write_count);
+            ret = sim_write(transfer->address, transfer->write_data,
+                            transfer->write_count);
+        }
+        if (ret || !transfer->read_count)
+            return ret;
+        if (transfer->delay_usec)
+            sim_sleep(transfer->delay_usec);
+        sim_transaction(transfer->read_count);
+        return sim_read(transfer->address, transfer->read_data,
+                        transfer->read_count);
+    }
+
+    /* one transaction: the read follows with a repeated start condition */
+    sim_transaction(
+        (uint16_t)(transfer->write_count + 1 + transfer->read_count));
+    ret = sim_write(transfer->address, transfer->write_data,
+                    transfer->write_count);
+    if (ret)
+        return ret;
+    return sim_read(transfer->address, transfer->read_data,
+                    transfer->read_count);
+}
+
+int8_t sensirion_i2c_transfer(const struct sensirion_i2c_transfer* transfer) {
+    int8_t ret;
+
+    sim_init();
+    sim_call_begin();
+    ret = sim_transfer(transfer);
+    sim_call_end();
+    return ret;
+}
+
+void sensirion_i2c_transfer_release(void) {
+}
+
+void sensirion_sleep_usec(uint32_t useconds) {
+    sim_call_begin();
+    sim_sleep(useconds);
+    sim_call_end();
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Combined I2C transfers for Linux user space (i2c-dev)
+ *
+ * Implements sensirion_i2c_transfer() with the I2C_RDWR ioctl, so a command
+ * and its response take a single system call. Use it together with the
+ * linux_user_space sample implementation of the I2C HAL.
+ */
+
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "sensirion_arch_config.h"
+#include "sensirion_i2c.h"
+#include "sensirion_i2c_transfer.h"
+
+/**
+ * Linux specific configuration. Adjust the following define to the device path
+ * of your sensor.
+ */
+#ifndef I2C_DEVICE_PATH
+#define I2C_DEVICE_PATH "/dev/i2c-1"
+#endif
+
+#define I2C_TRANSFER_ERROR (-1)
+
+static int i2c_transfer_device = -1;
+
+static int8_t i2c_transfer_messages(struct i2c_msg* messages,
+                                    uint32_t num_messages) {
+    struct i2c_rdwr_ioctl_data data;
+
+    data.msgs = messages;
+    data.nmsgs = num_messages;
+    if (ioctl(i2c_transfer_device, I2C_RDWR, &data) < 0)
+        return I2C_TRANSFER_ERROR;
+    return 0;
+}
+
+int8_t sensirion_i2c_transfer(const struct sensirion_i2c_transfer* transfer) {
+    struct i2c_msg messages[2];
+    uint32_t num_messages = 0;
+
+    if (i2c_transfer_device < 0) {
+        i2c_transfer_device = open(I2C_DEVICE_PATH, O_RDWR);
+        if (i2c_transfer_device < 0)
+            return I2C_TRANSFER_ERROR;
+    }
+
+    if (transfer->write_count) {
+        messages[num_messages].addr = transfer->address;
+        messages[num_messages].flags = 0;
+        messages[num_messages].len = transfer->write_count;
+        /* the kernel does not modify the data of write messages */
+        messages[num_messages].buf = (uint8_t*)transfer->write_data;
+        num_messages++;
+    }
+
+    if (transfer->read_count && transfer->delay_usec) {
+        if (num_messages && i2c_transfer_messages(messages, num_messages))
+            return I2C_TRANSFER_ERROR;
+        sensirion_sleep_usec(transfer->delay_usec);
+        num_messages = 0;
+    }
+
+    if (transfer->read_count) {
+        messages[num_messages].addr = transfer->address;
+        messages[num_messages].flags = I2C_M_RD;
+        messages[num_messages].len = transfer->read_count;
+        messages[num_messages].buf = transfer->read_data;
+        num_messages++;
+    }
+
+    if (!num_messages)
+        return 0;
+    return i2c_transfer_messages(messages, num_messages);
+}
+
+void sensirion_i2c_transfer_release(void) {
+    if (i2c_transfer_device >= 0)
+        close(i2c_transfer_device);
+    i2c_transfer_device = -1;
+}
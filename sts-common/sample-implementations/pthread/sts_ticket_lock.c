@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Fair bus lock for POSIX threads, implementation
+ */
+
+#include "sts_ticket_lock.h"
+
+int sts_ticket_lock_init(struct sts_ticket_lock* lock) {
+    int ret = pthread_mutex_init(&lock->mutex, NULL);
+    if (ret)
+        return ret;
+
+    ret = pthread_cond_init(&lock->served, NULL);
+    if (ret) {
+        pthread_mutex_destroy(&lock->mutex);
+        return ret;
+    }
+    lock->next_ticket = 0;
+    lock->now_serving = 0;
+    return 0;
+}
+
+void sts_ticket_lock_destroy(struct sts_ticket_lock* lock) {
+    pthread_cond_destroy(&lock->served);
+    pthread_mutex_destroy(&lock->mutex);
+}
+
+void sts_ticket_lock_acquire(void* lock) {
+    struct sts_ticket_lock* ticket_lock = (struct sts_ticket_lock*)lock;
+    unsigned long ticket;
+
+    pthread_mutex_lock(&ticket_lock->mutex);
+    ticket = ticket_lock->next_ticket++;
+    while (ticket != ticket_lock->now_serving)
+        pthread_cond_wait(&ticket_lock->served, &ticket_lock->mutex);
+    pthread_mutex_unlock(&ticket_lock->mutex);
+}
+
+void sts_ticket_lock_release(void* lock) {
+    struct sts_ticket_lock* ticket_lock = (struct sts_ticket_lock*)lock;
+
+    pthread_mutex_lock(&ticket_lock->mutex);
+    ticket_lock->now_serving++;
+    /* all waiters wake up, only the one with the next ticket proceeds */
+    pthread_cond_broadcast(&ticket_lock->served);
+    pthread_mutex_unlock(&ticket_lock->mutex);
+}
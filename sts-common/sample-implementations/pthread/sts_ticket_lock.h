@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Fair bus lock for POSIX threads
+ *
+ * Ticket lock to be used as struct sts3x_bus_lock on hosts with POSIX threads.
+ * Threads acquire the lock in the order in which they asked for it, so a
+ * thread which measures in a tight loop cannot starve other threads on the
+ * same bus. Example:
+ *
+ *     static struct sts_ticket_lock bus_lock;
+ *     static const struct sts3x_bus_lock lock = {
+ *         sts_ticket_lock_acquire, sts_ticket_lock_release, &bus_lock};
+ *
+ *     sts_ticket_lock_init(&bus_lock);
+ *     sts3x_set_bus_lock_dev(&dev, &lock);
+ */
+
+#ifndef STS_TICKET_LOCK_H
+#define STS_TICKET_LOCK_H
+
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sts_ticket_lock {
+    pthread_mutex_t mutex;
+    pthread_cond_t served;
+    unsigned long next_ticket; /* ticket of the next thread asking */
+    unsigned long now_serving; /* ticket of the thread holding the lock */
+};
+
+/**
+ * Initializes a ticket lock.
+ *
+ * @param lock  the lock
+ * @return      0 on success, else an error number
+ */
+int sts_ticket_lock_init(struct sts_ticket_lock* lock);
+
+/**
+ * Releases the resources of a ticket lock which is not held.
+ *
+ * @param lock  the lock
+ */
+void sts_ticket_lock_destroy(struct sts_ticket_lock* lock);
+
+/**
+ * Acquires a ticket lock, waiting for all threads which asked before.
+ *
+ * @param lock  pointer to a struct sts_ticket_lock
+ */
+void sts_ticket_lock_acquire(void* lock);
+
+/**
+ * Releases a ticket lock.
+ *
+ * @param lock  pointer to a struct sts_ticket_lock
+ */
+void sts_ticket_lock_release(void* lock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STS_TICKET_LOCK_H */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Combined I2C write and read transfers
+ *
+ * Optional extension of the I2C HAL (sensirion_i2c.h). If the driver is
+ * compiled with USE_SENSIRION_I2C_TRANSFER=1, it sends a command and reads its
+ * response with a single call to sensirion_i2c_transfer() instead of separate
+ * calls to sensirion_i2c_write() and sensirion_i2c_read(). Platforms which
+ * support combined transfers (e.g. I2C_RDWR on Linux) then need one bus access
+ * (and one system call) instead of two for responses without a wait between
+ * command and read, e.g. fetching periodic measurements. Transfers with a wait
+ * still release the bus in between.
+ */
+
+#ifndef SENSIRION_I2C_TRANSFER_H
+#define SENSIRION_I2C_TRANSFER_H
+
+#include "sensirion_arch_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Describes a write followed by a read from the same device.
+ */
+struct sensirion_i2c_transfer {
+    uint8_t address;           /* 7-bit I2C address */
+    const uint8_t* write_data; /* data to write, e.g. a command */
+    uint16_t write_count;      /* number of bytes to write, may be 0 */
+    uint32_t delay_usec;       /* wait between write and read */
+    uint8_t* read_data;        /* buffer for the data read */
+    uint16_t read_count;       /* number of bytes to read, may be 0 */
+};
+
+/**
+ * Executes a transfer. If delay_usec is 0, the read directly follows the write
+ * with a repeated start condition. Otherwise the bus is released for the delay.
+ *
+ * @param transfer  the transfer to execute
+ * @return          0 on success, an error code otherwise
+ */
+int8_t sensirion_i2c_transfer(const struct sensirion_i2c_transfer* transfer);
+
+/**
+ * Releases the resources used by sensirion_i2c_transfer(), if any.
+ */
+void sensirion_i2c_transfer_release(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSIRION_I2C_TRANSFER_H */
@@ -42,6 +42,9 @@
 #include "sensirion_arch_config.h"
 #include "sensirion_common.h"
 #include "sensirion_i2c.h"
+#if USE_SENSIRION_I2C_TRANSFER
+#include "sensirion_i2c_transfer.h"
+#endif /* USE_SENSIRION_I2C_TRANSFER */
 
 /* all measurement commands return T (CRC) RH (CRC) */
 #if USE_SENSIRION_CLOCK_STRETCHING
@@ -53,96 +56,1970 @@
 #define STS3X_CMD_MEASURE_MPM 0x240B
 #define STS3X_CMD_MEASURE_LPM 0x2416
 #endif /* USE_SENSIRION_CLOCK_STRETCHING */
+/* single shot measurement commands, indexed by repeatability */
+static const uint16_t STS3X_CMD_MEASURE[] = {
+    STS3X_CMD_MEASURE_HPM,
+    STS3X_CMD_MEASURE_MPM,
+    STS3X_CMD_MEASURE_LPM,
+};
+/* worst case measurement duration (datasheet maximum plus margin) */
+static const uint32_t STS3X_MEASUREMENT_DURATION_MAX_USEC[] = {
+    STS3X_MEASUREMENT_DURATION_USEC, /* high repeatability */
+    6500,                            /* medium repeatability */
+    4500,                            /* low repeatability */
+};
+#if !defined(USE_SENSIRION_CLOCK_STRETCHING) || !USE_SENSIRION_CLOCK_STRETCHING
+/* typical measurement duration, the earliest time the result is available */
+static const uint32_t STS3X_MEASUREMENT_DURATION_TYP_USEC[] = {
+    12500, /* high repeatability */
+    4500,  /* medium repeatability */
+    2500,  /* low repeatability */
+};
+static const uint32_t STS3X_POLL_INTERVAL_USEC = 500;
+#endif /* USE_SENSIRION_CLOCK_STRETCHING */
+#ifndef STS3X_DISABLE_PERIODIC
+/* periodic measurement commands, indexed by rate and then by repeatability */
+static const uint16_t STS3X_CMD_PERIODIC[][3] = {
+    {0x2032, 0x2024, 0x202F}, /* 0.5 mps */
+    {0x2130, 0x2126, 0x212D}, /* 1 mps */
+    {0x2236, 0x2220, 0x222B}, /* 2 mps */
+    {0x2334, 0x2322, 0x2329}, /* 4 mps */
+    {0x2737, 0x2721, 0x272A}, /* 10 mps */
+    {0x2B32, 0x2B32, 0x2B32}, /* ART, 4 mps */
+};
+static const uint32_t STS3X_PERIODIC_INTERVAL_USEC[] = {
+    2000000, /* 0.5 mps */
+    1000000, /* 1 mps */
+    500000,  /* 2 mps */
+    250000,  /* 4 mps */
+    100000,  /* 10 mps */
+    250000,  /* ART, 4 mps */
+};
+/* polling interval until a due periodic measurement is available */
+static const uint32_t STS3X_PERIODIC_POLL_INTERVAL_USEC = 1000;
+/* sts3x_periodic_blocking_read() wakes up this fraction of an interval before
+ * a measurement is due and polls at a quarter of it */
+static const uint32_t STS3X_PERIODIC_EARLY_FRACTION = 32;
+/* a due measurement which is this many intervals late is missing */
+static const uint32_t STS3X_PERIODIC_MAX_DELAY_INTERVALS = 2;
+/* states of measurement_pending in periodic mode */
+#define STS3X_PERIODIC_FIRST 0 /* no measurement read out yet */
+#define STS3X_PERIODIC_DUE 1   /* next measurement due at ready_at_usec */
+#define STS3X_PERIODIC_LATE 2  /* polling for the one due at ready_at_usec */
+static const uint16_t STS3X_CMD_FETCH_DATA = 0xE000;
+static const uint16_t STS3X_CMD_BREAK = 0x3093;
+#endif /* STS3X_DISABLE_PERIODIC */
 static const uint16_t STS3X_CMD_READ_STATUS_REG = 0xF32D;
-static const uint16_t STS3X_CMD_READ_SERIAL_ID = 0x3780;
+static const uint16_t STS3X_CMD_CLEAR_STATUS_REG = 0x3041;
 static const uint16_t STS3X_CMD_DURATION_USEC = 1000;
+#ifndef STS3X_DISABLE_RETRY
+static const uint16_t STS3X_CMD_SOFT_RESET = 0x30A2;
+#endif /* STS3X_DISABLE_RETRY */
+#ifndef STS3X_DISABLE_SERIAL
+static const uint16_t STS3X_CMD_READ_SERIAL_ID = 0x3780;
+#endif /* STS3X_DISABLE_SERIAL */
+#ifndef STS3X_DISABLE_DISCOVERY
+#ifdef STS3X_FIXED_ADDRESS
+static const uint8_t STS3X_DISCOVERY_ADDRESSES[] = {STS3X_FIXED_ADDRESS};
+#else
+static const uint8_t STS3X_DISCOVERY_ADDRESSES[] = {STS3X_ADDRESS_DEFAULT,
+                                                    STS3X_ADDRESS_ALTERNATE};
+#endif /* STS3X_FIXED_ADDRESS */
+#define STS3X_MUX_CHANNELS 8
+#endif /* STS3X_DISABLE_DISCOVERY */
+#ifndef STS3X_DISABLE_HEATER
 static const uint16_t STS3X_CMD_HEATER_ON = 0x306D;
 static const uint16_t STS3X_CMD_HEATER_OFF = 0x3066;
-#ifdef STS_ADDRESS
-static const uint8_t STS3X_ADDRESS = STS_ADDRESS;
+#define STS3X_SELF_TEST_STATE_IDLE 0
+#define STS3X_SELF_TEST_STATE_BASELINE 1
+#define STS3X_SELF_TEST_STATE_HEATING 2
+#define STS3X_SELF_TEST_STATE_HEATER_OFF 3
+#define STS3X_SELF_TEST_STATE_DONE 4
+#define STS3X_SELF_TEST_HEATER_OFF_ATTEMPTS 3
+#endif /* STS3X_DISABLE_HEATER */
+#ifndef STS3X_DISABLE_ALERT
+/* alert limit commands, indexed by STS3X_ALERT_LIMIT_* */
+static const uint16_t STS3X_CMD_READ_ALERT_LIMIT[] = {0xE11F, 0xE114, 0xE109,
+                                                      0xE102};
+static const uint16_t STS3X_CMD_WRITE_ALERT_LIMIT[] = {0x611D, 0x6116, 0x610B,
+                                                       0x6100};
+/**
+ * alert limits consist of the 7 most significant bits of the humidity (unused
+ * by the STS3x, set to never trigger) and the 9 most significant bits of the
+ * temperature signal
+ */
+#define STS3X_ALERT_LIMIT_TEMPERATURE_MASK 0x01FF
+#define STS3X_ALERT_LIMIT_TEMPERATURE_SHIFT 7
+#define STS3X_ALERT_LIMIT_HUMIDITY_MAX 0xFE00
+/* longest command argument: alert limit */
+#define STS3X_MAX_WRITE_WORDS 1
+#else
+#define STS3X_MAX_WRITE_WORDS 0
+#endif /* STS3X_DISABLE_ALERT */
+#ifndef STS3X_DISABLE_SERIAL
+/* longest response: serial number */
+#define STS3X_MAX_READ_WORDS 2
 #else
-static const uint8_t STS3X_ADDRESS = 0x4A;
+#define STS3X_MAX_READ_WORDS 1
+#endif /* STS3X_DISABLE_SERIAL */
+/* initial minimum latency, larger than any recorded latency */
+#define STS3X_LATENCY_MIN_UNSET 0xFFFFFFFF
+#if defined(STS3X_FIXED_ADDRESS)
+#define STS3X_ADDRESS STS3X_FIXED_ADDRESS
+#elif defined(STS_ADDRESS)
+#define STS3X_ADDRESS STS_ADDRESS
+#else
+#define STS3X_ADDRESS STS3X_ADDRESS_DEFAULT
 #endif
 
-static uint16_t sts3x_cmd_measure = STS3X_CMD_MEASURE_HPM;
+/* settings which are fixed at compile time are folded into constants */
+#ifdef STS3X_FIXED_ADDRESS
+#define STS3X_DEV_ADDRESS(dev) STS3X_FIXED_ADDRESS
+#else
+#define STS3X_DEV_ADDRESS(dev) ((dev)->address)
+#endif /* STS3X_FIXED_ADDRESS */
+#ifdef STS3X_FIXED_REPEATABILITY
+#define STS3X_REPEATABILITY(dev) STS3X_FIXED_REPEATABILITY
+#define STS3X_INITIAL_REPEATABILITY STS3X_FIXED_REPEATABILITY
+#else
+#define STS3X_REPEATABILITY(dev) ((dev)->repeatability)
+#define STS3X_INITIAL_REPEATABILITY 0
+#endif /* STS3X_FIXED_REPEATABILITY */
 
-int16_t sts3x_measure_blocking_read(int32_t* temperature) {
-    int8_t ret = sts3x_measure();
+static struct sts3x_dev sts3x_default_dev = {
+    STS3X_ADDRESS,                 /* address */
+    STS3X_INITIAL_REPEATABILITY,   /* repeatability */
+    STS3X_MODE_SINGLE_SHOT,        /* mode */
+    STS3X_MEASUREMENT_RATE_1_MPS,  /* periodic_rate */
+    NULL,                          /* select_bus */
+    NULL,                          /* bus */
+    0,                             /* measurement_pending */
+    0,                             /* ready_at_usec */
+    NULL,                          /* retry_policy */
+    0,                             /* consecutive_failures */
+    0,                             /* status */
+    0,                             /* status_valid */
+    NULL,                          /* bus_lock */
+#ifndef STS3X_DISABLE_CONVERSION
+    NULL, /* convert */
+    NULL, /* calibration */
+#endif /* STS3X_DISABLE_CONVERSION */
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    {0, 0, 0, 0, STS3X_LATENCY_MIN_UNSET, 0, 0, 0}, /* stats */
+    NULL,                                           /* clock */
+    NULL,                                           /* transaction_hook */
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+};
+
+int32_t sts3x_ticks_to_milli_celsius(uint16_t ticks) {
+    /**
+     * formula for conversion of the sensor signals, optimized for fixed point
+     * algebra: Temperature = 175 * S_T / 2^16 - 45
+     */
+    return ((21875 * (int32_t)ticks) >> 13) - 45000;
+}
+
+static int32_t sts3x_convert_dev(const struct sts3x_dev* dev, uint16_t ticks) {
+#ifndef STS3X_DISABLE_CONVERSION
+    if (dev->convert)
+        return dev->convert(ticks, dev->calibration);
+#else
+    (void)dev;
+#endif /* STS3X_DISABLE_CONVERSION */
+    return sts3x_ticks_to_milli_celsius(ticks);
+}
+
+static int16_t sts3x_select_dev(const struct sts3x_dev* dev) {
+    if (dev->select_bus)
+        return dev->select_bus(dev->bus);
+    return STATUS_OK;
+}
+
+/* held across each command sequence with a sensor, see struct sts3x_bus_lock */
+static void sts3x_lock_bus(const struct sts3x_dev* dev) {
+    if (dev->bus_lock)
+        dev->bus_lock->lock(dev->bus_lock->context);
+}
+
+static void sts3x_unlock_bus(const struct sts3x_dev* dev) {
+    if (dev->bus_lock)
+        dev->bus_lock->unlock(dev->bus_lock->context);
+}
+
+/**
+ * Returns the bus lock of devs which follows previous in address order, or
+ * NULL if there is none. Locking several buses in address order prevents
+ * deadlocks between threads which lock the same buses.
+ */
+static const struct sts3x_bus_lock*
+sts3x_next_bus_lock(const struct sts3x_dev* devs, uint16_t num_devs,
+                    const struct sts3x_bus_lock* previous) {
+    const struct sts3x_bus_lock* next = NULL;
+    const struct sts3x_bus_lock* lock;
+    uint16_t i;
+
+    for (i = 0; i < num_devs; ++i) {
+        lock = devs[i].bus_lock;
+        if (lock && (uintptr_t)lock > (uintptr_t)previous &&
+            (!next || (uintptr_t)lock < (uintptr_t)next))
+            next = lock;
+    }
+    return next;
+}
+
+static void sts3x_lock_buses(const struct sts3x_dev* devs, uint16_t num_devs) {
+    const struct sts3x_bus_lock* lock = NULL;
+
+    while ((lock = sts3x_next_bus_lock(devs, num_devs, lock)))
+        lock->lock(lock->context);
+}
+
+static void sts3x_unlock_buses(const struct sts3x_dev* devs,
+                               uint16_t num_devs) {
+    const struct sts3x_bus_lock* lock = NULL;
+
+    while ((lock = sts3x_next_bus_lock(devs, num_devs, lock)))
+        lock->unlock(lock->context);
+}
+
+/*
+ * The *_unlocked() functions implement the *_dev() functions of the same name
+ * and expect the bus lock of the sensor to be held.
+ */
+static int16_t sts3x_measure_unlocked(struct sts3x_dev* dev);
+static int16_t sts3x_read_unlocked(struct sts3x_dev* dev,
+                                   int32_t* temperature);
+static int16_t sts3x_read_ticks_unlocked(struct sts3x_dev* dev,
+                                         uint16_t* ticks);
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+static uint32_t sts3x_transaction_start(const struct sts3x_dev* dev) {
+    return dev->clock ? dev->clock() : 0;
+}
+
+static void sts3x_transaction_done(struct sts3x_dev* dev, uint8_t direction,
+                                   uint16_t num_bytes, int16_t result,
+                                   uint32_t start_usec) {
+    struct sts3x_stats* stats = &dev->stats;
+    uint32_t duration_usec = 0;
+
+    stats->transactions++;
+    if (result == STATUS_CRC_FAIL)
+        stats->crc_errors++;
+    else if (result)
+        stats->nacks++;
+
+    if (dev->clock) {
+        duration_usec = dev->clock() - start_usec;
+        if (duration_usec < stats->latency_min_usec)
+            stats->latency_min_usec = duration_usec;
+        if (duration_usec > stats->latency_max_usec)
+            stats->latency_max_usec = duration_usec;
+        stats->latency_total_usec += duration_usec;
+    }
+
+    if (dev->transaction_hook)
+        dev->transaction_hook(dev, direction, num_bytes, result, duration_usec);
+}
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+
+/* all transactions with the sensor go through the following two functions */
+static int16_t sts3x_i2c_write_cmd(struct sts3x_dev* dev, uint16_t command,
+                                   const uint16_t* args, uint8_t num_args) {
+    uint8_t buf[SENSIRION_COMMAND_SIZE +
+                STS3X_MAX_WRITE_WORDS * (SENSIRION_WORD_SIZE + CRC8_LEN)];
+    uint16_t size;
+    int16_t ret;
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    uint32_t start_usec = sts3x_transaction_start(dev);
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+
+    if (num_args > STS3X_MAX_WRITE_WORDS)
+        return STATUS_ERR_BAD_DATA;
+
+    size = sensirion_fill_cmd_send_buf(buf, command, args, num_args);
+    ret = sensirion_i2c_write(STS3X_DEV_ADDRESS(dev), buf, size) ? STATUS_NACK
+                                                                 : STATUS_OK;
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    sts3x_transaction_done(dev, STS3X_TRANSACTION_WRITE, size, ret,
+                           start_usec);
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+    return ret;
+}
+
+/* checks the CRC of each word of a response and stores the words */
+static int16_t sts3x_check_words(const uint8_t* buf, uint16_t size,
+                                 uint16_t* words) {
+    uint16_t i;
+
+    for (i = 0; i < size; i += SENSIRION_WORD_SIZE + CRC8_LEN) {
+        if (sensirion_common_generate_crc(&buf[i], SENSIRION_WORD_SIZE) !=
+            buf[i + SENSIRION_WORD_SIZE])
+            return STATUS_CRC_FAIL;
+        words[i / (SENSIRION_WORD_SIZE + CRC8_LEN)] =
+            sensirion_bytes_to_uint16_t(&buf[i]);
+    }
+    return STATUS_OK;
+}
+
+static int16_t sts3x_i2c_read_words(struct sts3x_dev* dev, uint16_t* words,
+                                    uint16_t num_words) {
+    uint8_t buf[STS3X_MAX_READ_WORDS * (SENSIRION_WORD_SIZE + CRC8_LEN)];
+    const uint16_t size = num_words * (SENSIRION_WORD_SIZE + CRC8_LEN);
+    int16_t ret;
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    uint32_t start_usec = sts3x_transaction_start(dev);
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+
+    if (num_words > STS3X_MAX_READ_WORDS)
+        return STATUS_ERR_BAD_DATA;
+
+    ret = sensirion_i2c_read(STS3X_DEV_ADDRESS(dev), buf, size) ? STATUS_NACK
+                                                                 : STATUS_OK;
+    if (ret == STATUS_OK)
+        ret = sts3x_check_words(buf, size, words);
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    sts3x_transaction_done(dev, STS3X_TRANSACTION_READ, size, ret, start_usec);
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+    return ret;
+}
+
+#if !defined(STS3X_DISABLE_DISCOVERY) || \
+    (USE_SENSIRION_I2C_TRANSFER && !defined(STS3X_DISABLE_PERIODIC))
+/* address only transaction, acknowledged if a sensor is present */
+static int16_t sts3x_i2c_probe_address(struct sts3x_dev* dev) {
+    int16_t ret;
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    uint32_t start_usec = sts3x_transaction_start(dev);
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+
+    ret = sensirion_i2c_write(STS3X_DEV_ADDRESS(dev), NULL, 0) ? STATUS_NACK
+                                                               : STATUS_OK;
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    sts3x_transaction_done(dev, STS3X_TRANSACTION_WRITE, 0, ret, start_usec);
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+    return ret;
+}
+#endif /* STS3X_DISABLE_DISCOVERY || USE_SENSIRION_I2C_TRANSFER */
+
+#if USE_SENSIRION_I2C_TRANSFER
+/* sends a command and reads the response with one combined transfer */
+static int16_t sts3x_i2c_transfer_cmd(struct sts3x_dev* dev, uint16_t command,
+                                      uint32_t delay_usec, uint16_t* words,
+                                      uint16_t num_words) {
+    uint8_t cmd_buf[SENSIRION_COMMAND_SIZE];
+    uint8_t buf[STS3X_MAX_READ_WORDS * (SENSIRION_WORD_SIZE + CRC8_LEN)];
+    struct sensirion_i2c_transfer transfer;
+    int16_t ret;
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    uint32_t start_usec = sts3x_transaction_start(dev);
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+
+    if (num_words > STS3X_MAX_READ_WORDS)
+        return STATUS_ERR_BAD_DATA;
+
+    transfer.address = STS3X_DEV_ADDRESS(dev);
+    transfer.write_data = cmd_buf;
+    transfer.write_count =
+        sensirion_fill_cmd_send_buf(cmd_buf, command, NULL, 0);
+    transfer.delay_usec = delay_usec;
+    transfer.read_data = buf;
+    transfer.read_count = num_words * (SENSIRION_WORD_SIZE + CRC8_LEN);
+
+    ret = sensirion_i2c_transfer(&transfer) ? STATUS_NACK : STATUS_OK;
+    if (ret == STATUS_OK)
+        ret = sts3x_check_words(buf, transfer.read_count, words);
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    sts3x_transaction_done(dev, STS3X_TRANSACTION_WRITE_READ,
+                           transfer.write_count + transfer.read_count, ret,
+                           start_usec);
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+    return ret;
+}
+#endif /* USE_SENSIRION_I2C_TRANSFER */
+
+#ifndef STS3X_DISABLE_RETRY
+static void sts3x_recover_bus(struct sts3x_dev* dev) {
+    int16_t ret;
+
+    if (dev->retry_policy->bus_clear)
+        dev->retry_policy->bus_clear(dev->bus);
+
+    /* only resets this sensor, other sensors on the bus keep their state */
+    sts3x_select_dev(dev);
+#ifndef STS3X_DISABLE_PERIODIC
+    if (dev->mode == STS3X_MODE_PERIODIC) {
+        sts3x_i2c_write_cmd(dev, STS3X_CMD_BREAK, NULL, 0);
+        sensirion_sleep_usec(STS3X_CMD_DURATION_USEC);
+    }
+#endif /* STS3X_DISABLE_PERIODIC */
+    ret = sts3x_i2c_write_cmd(dev, STS3X_CMD_SOFT_RESET, NULL, 0);
+    sensirion_sleep_usec(STS3X_CMD_DURATION_USEC);
+    dev->mode = STS3X_MODE_SINGLE_SHOT;
+    dev->measurement_pending = 0;
+    /* the status register is back at its power up value */
+    if (ret)
+        dev->status_valid = 0;
+    else if (dev->status_valid)
+        dev->status = STS3X_STATUS_ALERT_PENDING | STS3X_STATUS_RESET_DETECTED;
+}
+
+/**
+ * Tracks failed transactions which were not recovered by retries and recovers
+ * the bus once the recovery threshold of the retry policy is reached.
+ */
+static int16_t sts3x_transaction_result(struct sts3x_dev* dev, int16_t ret) {
+    const struct sts3x_retry_policy* policy = dev->retry_policy;
+
+    if (ret == STATUS_OK) {
+        dev->consecutive_failures = 0;
+        return STATUS_OK;
+    }
+
+    if (!policy || !policy->recovery_threshold ||
+        ++dev->consecutive_failures < policy->recovery_threshold)
+        return ret;
+
+    dev->consecutive_failures = 0;
+    sts3x_recover_bus(dev);
+    return STATUS_BUS_RESET;
+}
+
+/**
+ * Waits before the next retry of a failed transaction.
+ *
+ * @return 1 if the transaction should be retried, 0 if the retries are used up
+ */
+static uint8_t sts3x_retry_backoff(struct sts3x_dev* dev, uint8_t retry) {
+    const struct sts3x_retry_policy* policy = dev->retry_policy;
+    uint32_t backoff_usec;
+    uint8_t i;
+
+    if (!policy || retry >= policy->max_retries)
+        return 0;
+
+    backoff_usec = policy->backoff_usec;
+    for (i = 0; i < retry && backoff_usec < policy->max_backoff_usec; ++i)
+        backoff_usec *= 2;
+    if (backoff_usec > policy->max_backoff_usec)
+        backoff_usec = policy->max_backoff_usec;
+    if (backoff_usec)
+        sensirion_sleep_usec(backoff_usec);
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    dev->stats.retries++;
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+    return 1;
+}
+
+#else
+static int16_t sts3x_transaction_result(struct sts3x_dev* dev, int16_t ret) {
+    (void)dev;
+    return ret;
+}
+
+static uint8_t sts3x_retry_backoff(struct sts3x_dev* dev, uint8_t retry) {
+    (void)dev;
+    (void)retry;
+    return 0;
+}
+#endif /* STS3X_DISABLE_RETRY */
+
+static int16_t sts3x_write_cmd_with_args(struct sts3x_dev* dev,
+                                         uint16_t command, const uint16_t* args,
+                                         uint8_t num_args) {
+    uint8_t retry = 0;
+    int16_t ret;
+
+    while ((ret = sts3x_i2c_write_cmd(dev, command, args, num_args)) !=
+               STATUS_OK &&
+           sts3x_retry_backoff(dev, retry++)) {
+    }
+    return sts3x_transaction_result(dev, ret);
+}
+
+static int16_t sts3x_write_cmd(struct sts3x_dev* dev, uint16_t command) {
+    return sts3x_write_cmd_with_args(dev, command, NULL, 0);
+}
+
+/**
+ * Reads a response and retries if it is not acknowledged. Responses with a
+ * wrong CRC are not retried here, the sensor discards a response once it is
+ * read out.
+ */
+static int16_t sts3x_read_words(struct sts3x_dev* dev, uint16_t* words,
+                                uint16_t num_words) {
+    uint8_t retry = 0;
+    int16_t ret;
+
+    while ((ret = sts3x_i2c_read_words(dev, words, num_words)) == STATUS_NACK &&
+           sts3x_retry_backoff(dev, retry++)) {
+    }
+    return sts3x_transaction_result(dev, ret);
+}
+
+#if USE_SENSIRION_I2C_TRANSFER
+static int16_t sts3x_transfer_cmd(struct sts3x_dev* dev, uint16_t command,
+                                  uint32_t delay_usec, uint16_t* words,
+                                  uint16_t num_words) {
+    uint8_t retry = 0;
+    int16_t ret;
+
+    while ((ret = sts3x_i2c_transfer_cmd(dev, command, delay_usec, words,
+                                         num_words)) == STATUS_NACK &&
+           sts3x_retry_backoff(dev, retry++)) {
+    }
+    return sts3x_transaction_result(dev, ret);
+}
+#endif /* USE_SENSIRION_I2C_TRANSFER */
+
+/**
+ * Sends a command and reads its response. Unlike measurement results, such
+ * responses can be requested again, so the whole sequence is retried if the
+ * response has a wrong CRC.
+ */
+static int16_t sts3x_read_cmd(struct sts3x_dev* dev, uint16_t command,
+                              uint16_t* words, uint16_t num_words) {
+    uint8_t retry = 0;
+    int16_t ret;
+
+    do {
+#if USE_SENSIRION_I2C_TRANSFER
+        ret = sts3x_transfer_cmd(dev, command, STS3X_CMD_DURATION_USEC, words,
+                                 num_words);
+#else
+        ret = sts3x_write_cmd(dev, command);
+        if (ret)
+            return ret;
+
+        sensirion_sleep_usec(STS3X_CMD_DURATION_USEC);
+        ret = sts3x_read_words(dev, words, num_words);
+#endif /* USE_SENSIRION_I2C_TRANSFER */
+    } while (ret == STATUS_CRC_FAIL && sts3x_retry_backoff(dev, retry++));
+    return ret;
+}
+
+void sts3x_init_dev(struct sts3x_dev* dev, uint8_t address) {
+    dev->address = address;
+    dev->repeatability = STS3X_INITIAL_REPEATABILITY;
+    dev->mode = STS3X_MODE_SINGLE_SHOT;
+    dev->periodic_rate = STS3X_MEASUREMENT_RATE_1_MPS;
+    dev->select_bus = NULL;
+    dev->bus = NULL;
+    dev->measurement_pending = 0;
+    dev->ready_at_usec = 0;
+    dev->retry_policy = NULL;
+    dev->consecutive_failures = 0;
+    dev->status = 0;
+    dev->status_valid = 0;
+    dev->bus_lock = NULL;
+#ifndef STS3X_DISABLE_CONVERSION
+    dev->convert = NULL;
+    dev->calibration = NULL;
+#endif /* STS3X_DISABLE_CONVERSION */
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    sts3x_reset_stats_dev(dev);
+    dev->clock = NULL;
+    dev->transaction_hook = NULL;
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+}
+
+int16_t sts3x_select_i2c_mux_channel(void* mux_channel) {
+    const struct sts3x_i2c_mux_channel* mux =
+        (const struct sts3x_i2c_mux_channel*)mux_channel;
+    const uint8_t channel_mask = (uint8_t)(1 << mux->channel);
+
+    return sensirion_i2c_write(mux->mux_address, &channel_mask, 1);
+}
+
+static int16_t sts3x_measure_blocking_read_unlocked(struct sts3x_dev* dev,
+                                                    int32_t* temperature) {
+#if USE_SENSIRION_I2C_TRANSFER && USE_SENSIRION_CLOCK_STRETCHING
+    /* the sensor stretches the read until the measurement is done */
+    uint16_t ticks;
+    int16_t ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    ret = sts3x_transfer_cmd(dev, STS3X_CMD_MEASURE[STS3X_REPEATABILITY(dev)],
+                             0, &ticks, 1);
+    if (ret == STATUS_OK)
+        *temperature = sts3x_convert_dev(dev, ticks);
+    return ret;
+#else
+    int16_t ret = sts3x_measure_unlocked(dev);
     if (ret == STATUS_OK) {
 #if !defined(USE_SENSIRION_CLOCK_STRETCHING) || !USE_SENSIRION_CLOCK_STRETCHING
-        sensirion_sleep_usec(STS3X_MEASUREMENT_DURATION_USEC);
+        sensirion_sleep_usec(sts3x_get_measurement_duration_usec_dev(dev));
 #endif /* USE_SENSIRION_CLOCK_STRETCHING */
-        ret = sts3x_read(temperature);
+        ret = sts3x_read_unlocked(dev, temperature);
     }
     return ret;
+#endif /* USE_SENSIRION_I2C_TRANSFER && USE_SENSIRION_CLOCK_STRETCHING */
 }
 
-int16_t sts3x_measure() {
-    return sensirion_i2c_write_cmd(STS3X_ADDRESS, sts3x_cmd_measure);
+int16_t sts3x_measure_blocking_read_dev(struct sts3x_dev* dev,
+                                        int32_t* temperature) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_measure_blocking_read_unlocked(dev, temperature);
+    sts3x_unlock_bus(dev);
+    return ret;
 }
 
-int16_t sts3x_read(int32_t* temperature) {
-    uint16_t word;
-    int16_t ret = sensirion_i2c_read_words(STS3X_ADDRESS, &word, 1);
-    /**
-     * formula for conversion of the sensor signals, optimized for fixed point
-     * algebra: Temperature = 175 * S_T / 2^16 - 45
-     */
-    *temperature = ((21875 * (int32_t)word) >> 13) - 45000;
+int16_t sts3x_measure_blocking_read_batch(struct sts3x_dev* devs,
+                                          uint16_t num_devs,
+                                          int32_t* temperatures,
+                                          int16_t* status) {
+    uint32_t duration;
+    uint32_t max_duration = 0;
+    int16_t ret = STATUS_OK;
+    uint16_t i;
+
+    sts3x_lock_buses(devs, num_devs);
+    for (i = 0; i < num_devs; ++i) {
+        status[i] = sts3x_measure_unlocked(&devs[i]);
+        duration = sts3x_get_measurement_duration_usec_dev(&devs[i]);
+        if (status[i] == STATUS_OK && duration > max_duration)
+            max_duration = duration;
+    }
 
+#if !defined(USE_SENSIRION_CLOCK_STRETCHING) || !USE_SENSIRION_CLOCK_STRETCHING
+    if (max_duration)
+        sensirion_sleep_usec(max_duration);
+#endif /* USE_SENSIRION_CLOCK_STRETCHING */
+
+    for (i = 0; i < num_devs; ++i) {
+        if (status[i] == STATUS_OK)
+            status[i] = sts3x_read_unlocked(&devs[i], &temperatures[i]);
+        if (status[i] != STATUS_OK && ret == STATUS_OK)
+            ret = status[i];
+    }
+    sts3x_unlock_buses(devs, num_devs);
     return ret;
 }
 
-int16_t sts3x_probe() {
-    uint16_t status;
-    return sensirion_i2c_delayed_read_cmd(STS3X_ADDRESS,
-                                          STS3X_CMD_READ_STATUS_REG,
-                                          STS3X_CMD_DURATION_USEC, &status, 1);
+static int16_t sts3x_measure_polling_read_unlocked(struct sts3x_dev* dev,
+                                                   int32_t* temperature) {
+#if !defined(USE_SENSIRION_CLOCK_STRETCHING) || !USE_SENSIRION_CLOCK_STRETCHING
+    uint32_t waited =
+        STS3X_MEASUREMENT_DURATION_TYP_USEC[STS3X_REPEATABILITY(dev)];
+    uint32_t max_wait = sts3x_get_measurement_duration_usec_dev(dev);
+    uint16_t ticks;
+#endif /* USE_SENSIRION_CLOCK_STRETCHING */
+    int16_t ret = sts3x_measure_unlocked(dev);
+    if (ret != STATUS_OK)
+        return ret;
+
+#if !defined(USE_SENSIRION_CLOCK_STRETCHING) || !USE_SENSIRION_CLOCK_STRETCHING
+    sensirion_sleep_usec(waited);
+    /* the sensor does not acknowledge the read until the result is ready */
+    while ((ret = sts3x_i2c_read_words(dev, &ticks, 1)) == STATUS_NACK &&
+           waited < max_wait) {
+        sensirion_sleep_usec(STS3X_POLL_INTERVAL_USEC);
+        waited += STS3X_POLL_INTERVAL_USEC;
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+        dev->stats.retries++;
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+    }
+#ifndef STS3X_DISABLE_RETRY
+    /* give the retry policy a chance after the worst case duration */
+    if (ret == STATUS_NACK && dev->retry_policy)
+        return sts3x_read_unlocked(dev, temperature);
+#endif /* STS3X_DISABLE_RETRY */
+
+    ret = sts3x_transaction_result(dev, ret);
+    if (ret == STATUS_OK)
+        *temperature = sts3x_convert_dev(dev, ticks);
+    return ret;
+#else
+    return sts3x_read_unlocked(dev, temperature);
+#endif /* USE_SENSIRION_CLOCK_STRETCHING */
 }
 
-void sts3x_set_repeatability(uint8_t repeatability) {
-    switch (repeatability) {
-        case 2:
-            sts3x_cmd_measure = STS3X_CMD_MEASURE_LPM;
-            break;
-        case 1:
-            sts3x_cmd_measure = STS3X_CMD_MEASURE_MPM;
-            break;
-        case 0:
-        default:
-            sts3x_cmd_measure = STS3X_CMD_MEASURE_HPM;
-            break;
+int16_t sts3x_measure_polling_read_dev(struct sts3x_dev* dev,
+                                       int32_t* temperature) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_measure_polling_read_unlocked(dev, temperature);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+static int16_t sts3x_measure_poll_unlocked(struct sts3x_dev* dev,
+                                           sts3x_clock_usec_fn clock,
+                                           int32_t* temperature,
+                                           uint32_t* ready_at_usec) {
+    int16_t ret;
+
+    if (!dev->measurement_pending) {
+        ret = sts3x_measure_unlocked(dev);
+        if (ret)
+            return ret;
+
+        dev->ready_at_usec =
+            clock() + sts3x_get_measurement_duration_usec_dev(dev);
+        dev->measurement_pending = 1;
+        *ready_at_usec = dev->ready_at_usec;
+        return STATUS_IN_PROGRESS;
+    }
+
+    /* signed difference to handle the wrap around of the clock */
+    if ((int32_t)(clock() - dev->ready_at_usec) < 0) {
+        *ready_at_usec = dev->ready_at_usec;
+        return STATUS_IN_PROGRESS;
     }
+
+    dev->measurement_pending = 0;
+    return sts3x_read_unlocked(dev, temperature);
 }
 
-int16_t sts3x_heater_on(void) {
-    return sensirion_i2c_write_cmd(STS3X_ADDRESS, STS3X_CMD_HEATER_ON);
+int16_t sts3x_measure_poll_dev(struct sts3x_dev* dev,
+                               sts3x_clock_usec_fn clock, int32_t* temperature,
+                               uint32_t* ready_at_usec) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_measure_poll_unlocked(dev, clock, temperature, ready_at_usec);
+    sts3x_unlock_bus(dev);
+    return ret;
 }
 
-int16_t sts3x_read_serial(uint32_t* serial) {
+static int16_t sts3x_measure_unlocked(struct sts3x_dev* dev) {
+    int16_t ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    return sts3x_write_cmd(dev, STS3X_CMD_MEASURE[STS3X_REPEATABILITY(dev)]);
+}
+
+int16_t sts3x_measure_dev(struct sts3x_dev* dev) {
     int16_t ret;
-    uint8_t serial_bytes[4];
 
-    ret = sensirion_i2c_write_cmd(STS3X_ADDRESS, STS3X_CMD_READ_SERIAL_ID);
+    sts3x_lock_bus(dev);
+    ret = sts3x_measure_unlocked(dev);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+uint32_t sts3x_get_measurement_duration_usec_dev(const struct sts3x_dev* dev) {
+    return STS3X_MEASUREMENT_DURATION_MAX_USEC[STS3X_REPEATABILITY(dev)];
+}
+
+uint32_t sts3x_get_measurement_duration_usec_for(uint8_t repeatability) {
+    if (repeatability > 2)
+        repeatability = 0;
+    return STS3X_MEASUREMENT_DURATION_MAX_USEC[repeatability];
+}
+
+static int16_t sts3x_read_unlocked(struct sts3x_dev* dev,
+                                   int32_t* temperature) {
+    uint16_t ticks;
+    int16_t ret = sts3x_read_ticks_unlocked(dev, &ticks);
     if (ret)
         return ret;
 
-    sensirion_sleep_usec(STS3X_CMD_DURATION_USEC);
+    *temperature = sts3x_convert_dev(dev, ticks);
+    return STATUS_OK;
+}
+
+int16_t sts3x_read_dev(struct sts3x_dev* dev, int32_t* temperature) {
+    int16_t ret;
 
-    ret = sensirion_i2c_read_words_as_bytes(STS3X_ADDRESS, serial_bytes,
-                                            SENSIRION_NUM_WORDS(serial_bytes));
-    *serial = sensirion_bytes_to_uint32_t(serial_bytes);
+    sts3x_lock_bus(dev);
+    ret = sts3x_read_unlocked(dev, temperature);
+    sts3x_unlock_bus(dev);
     return ret;
 }
 
-int16_t sts3x_heater_off(void) {
-    return sensirion_i2c_write_cmd(STS3X_ADDRESS, STS3X_CMD_HEATER_OFF);
+static int16_t sts3x_read_ticks_unlocked(struct sts3x_dev* dev,
+                                         uint16_t* ticks) {
+    int16_t ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    return sts3x_read_words(dev, ticks, 1);
+}
+
+int16_t sts3x_read_ticks_dev(struct sts3x_dev* dev, uint16_t* ticks) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_read_ticks_unlocked(dev, ticks);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+#ifndef STS3X_DISABLE_PERIODIC
+static int16_t sts3x_start_periodic_measurement_unlocked(struct sts3x_dev* dev,
+                                                         uint8_t rate) {
+    int16_t ret;
+
+    if (rate > STS3X_MEASUREMENT_RATE_ART)
+        return STATUS_ERR_BAD_DATA;
+
+    ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    ret = sts3x_write_cmd(dev,
+                          STS3X_CMD_PERIODIC[rate][STS3X_REPEATABILITY(dev)]);
+    if (ret == STATUS_OK) {
+        dev->mode = STS3X_MODE_PERIODIC;
+        dev->periodic_rate = rate;
+        dev->measurement_pending = 0;
+    }
+    return ret;
+}
+
+int16_t sts3x_start_periodic_measurement_dev(struct sts3x_dev* dev,
+                                             uint8_t rate) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_start_periodic_measurement_unlocked(dev, rate);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+/**
+ * Reads out the latest periodic measurement. The read is not acknowledged if
+ * there is no new result, which is not retried and returns STATUS_IN_PROGRESS.
+ * A command which is not acknowledged is an error, the sensor is missing.
+ */
+static int16_t sts3x_fetch_ticks_unlocked(struct sts3x_dev* dev,
+                                          uint16_t* ticks) {
+    int16_t ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+#if USE_SENSIRION_I2C_TRANSFER
+    ret = sts3x_i2c_transfer_cmd(dev, STS3X_CMD_FETCH_DATA, 0, ticks, 1);
+    if (ret != STATUS_NACK)
+        return ret;
+
+    /* the transfer does not tell if the command or the read failed */
+    ret = sts3x_transaction_result(dev, sts3x_i2c_probe_address(dev));
+    return ret ? ret : STATUS_IN_PROGRESS;
+#else
+    ret = sts3x_write_cmd(dev, STS3X_CMD_FETCH_DATA);
+    if (ret)
+        return ret;
+
+    ret = sts3x_i2c_read_words(dev, ticks, 1);
+    return ret == STATUS_NACK ? STATUS_IN_PROGRESS : ret;
+#endif /* USE_SENSIRION_I2C_TRANSFER */
+}
+
+int16_t sts3x_fetch_ticks_dev(struct sts3x_dev* dev, uint16_t* ticks) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_fetch_ticks_unlocked(dev, ticks);
+    sts3x_unlock_bus(dev);
+    return ret == STATUS_IN_PROGRESS ? STATUS_NACK : ret;
+}
+
+int16_t sts3x_fetch_data_dev(struct sts3x_dev* dev, int32_t* temperature) {
+    uint16_t ticks;
+    int16_t ret = sts3x_fetch_ticks_dev(dev, &ticks);
+    if (ret)
+        return ret;
+
+    *temperature = sts3x_convert_dev(dev, ticks);
+    return STATUS_OK;
+}
+
+int16_t sts3x_periodic_blocking_read_dev(struct sts3x_dev* dev,
+                                         int32_t* temperature) {
+    const uint32_t interval = STS3X_PERIODIC_INTERVAL_USEC[dev->periodic_rate];
+    const uint32_t early = interval / STS3X_PERIODIC_EARLY_FRACTION;
+    uint32_t waited;
+    uint16_t ticks;
+    int16_t ret;
+
+    /* poll from shortly before the measurement is due, so the read outs
+     * follow the clock of the sensor instead of drifting against it */
+    sensirion_sleep_usec(interval - early);
+    for (waited = 0;; waited += early / 4) {
+        sts3x_lock_bus(dev);
+        ret = sts3x_fetch_ticks_unlocked(dev, &ticks);
+        sts3x_unlock_bus(dev);
+        if (ret != STATUS_IN_PROGRESS)
+            break;
+        if (waited >= interval + early)
+            return STATUS_NACK;
+        sensirion_sleep_usec(early / 4);
+    }
+    if (ret)
+        return ret;
+
+    *temperature = sts3x_convert_dev(dev, ticks);
+    return STATUS_OK;
+}
+
+/**
+ * In periodic mode, measurement_pending is one of STS3X_PERIODIC_* and
+ * ready_at_usec the time the next measurement is due. A measurement which is
+ * not available when due is polled for until it is found, then the schedule
+ * follows the clock of the sensor.
+ */
+static int16_t sts3x_fetch_timestamped_unlocked(struct sts3x_dev* dev,
+                                                sts3x_clock_usec_fn clock,
+                                                int32_t* temperature,
+                                                uint32_t* timestamp_usec,
+                                                uint32_t* ready_at_usec) {
+    const uint32_t interval = STS3X_PERIODIC_INTERVAL_USEC[dev->periodic_rate];
+    uint32_t now = clock();
+    uint32_t measured_at;
+    uint16_t ticks;
+    int16_t ret;
+
+    /* signed difference to handle the wrap around of the clock */
+    if (dev->measurement_pending == STS3X_PERIODIC_DUE &&
+        (int32_t)(now - dev->ready_at_usec) < 0) {
+        *ready_at_usec = dev->ready_at_usec;
+        return STATUS_IN_PROGRESS;
+    }
+
+    ret = sts3x_fetch_ticks_unlocked(dev, &ticks);
+    if (ret == STATUS_IN_PROGRESS) {
+        if (dev->measurement_pending == STS3X_PERIODIC_FIRST)
+            dev->ready_at_usec = now;
+        dev->measurement_pending = STS3X_PERIODIC_LATE;
+        /* e.g. reset or stopped, the sensor does not measure anymore */
+        if (now - dev->ready_at_usec >=
+            STS3X_PERIODIC_MAX_DELAY_INTERVALS * interval)
+            return STATUS_NACK;
+
+        *ready_at_usec = now + STS3X_PERIODIC_POLL_INTERVAL_USEC;
+        return STATUS_IN_PROGRESS;
+    }
+    if (ret)
+        return ret;
+
+    measured_at = dev->measurement_pending == STS3X_PERIODIC_DUE
+                      ? dev->ready_at_usec
+                      : now;
+    /* the sensor only keeps the latest measurement, skip missed ones */
+    while ((int32_t)(now - (measured_at + interval)) >= 0)
+        measured_at += interval;
+
+    dev->measurement_pending = STS3X_PERIODIC_DUE;
+    dev->ready_at_usec = measured_at + interval;
+    *timestamp_usec = measured_at;
+    *temperature = sts3x_convert_dev(dev, ticks);
+    return STATUS_OK;
+}
+
+int16_t sts3x_fetch_timestamped_dev(struct sts3x_dev* dev,
+                                    sts3x_clock_usec_fn clock,
+                                    int32_t* temperature,
+                                    uint32_t* timestamp_usec,
+                                    uint32_t* ready_at_usec) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_fetch_timestamped_unlocked(dev, clock, temperature,
+                                           timestamp_usec, ready_at_usec);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+static int16_t sts3x_stop_periodic_measurement_unlocked(struct sts3x_dev* dev) {
+    int16_t ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    ret = sts3x_write_cmd(dev, STS3X_CMD_BREAK);
+    if (ret)
+        return ret;
+
+    dev->mode = STS3X_MODE_SINGLE_SHOT;
+    dev->measurement_pending = 0;
+    /* the sensor needs to settle before it accepts the next command */
+    sensirion_sleep_usec(STS3X_CMD_DURATION_USEC);
+    return STATUS_OK;
+}
+
+int16_t sts3x_stop_periodic_measurement_dev(struct sts3x_dev* dev) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_stop_periodic_measurement_unlocked(dev);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+#endif /* STS3X_DISABLE_PERIODIC */
+
+int16_t sts3x_probe_dev(struct sts3x_dev* dev) {
+    uint16_t status;
+    return sts3x_read_status_dev(dev, &status);
+}
+
+static int16_t sts3x_read_status_unlocked(struct sts3x_dev* dev,
+                                          uint16_t* status) {
+    int16_t ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    ret = sts3x_read_cmd(dev, STS3X_CMD_READ_STATUS_REG, status, 1);
+    if (ret)
+        return ret;
+
+    dev->status = *status;
+    dev->status_valid = 1;
+    return STATUS_OK;
+}
+
+int16_t sts3x_read_status_dev(struct sts3x_dev* dev, uint16_t* status) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_read_status_unlocked(dev, status);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+static int16_t sts3x_clear_status_unlocked(struct sts3x_dev* dev) {
+    int16_t ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    ret = sts3x_write_cmd(dev, STS3X_CMD_CLEAR_STATUS_REG);
+    if (ret)
+        return ret;
+
+    dev->status &= STS3X_STATUS_HEATER_ON;
+    return STATUS_OK;
+}
+
+int16_t sts3x_clear_status_dev(struct sts3x_dev* dev) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_clear_status_unlocked(dev);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+int16_t sts3x_get_cached_status_dev(const struct sts3x_dev* dev,
+                                    uint16_t* status) {
+    if (!dev->status_valid)
+        return STATUS_ERR_BAD_DATA;
+
+    *status = dev->status;
+    return STATUS_OK;
+}
+
+#ifndef STS3X_DISABLE_ALERT
+static uint16_t sts3x_encode_alert_limit(uint8_t limit, int32_t temperature) {
+    int32_t value;
+
+    if (temperature < -45000)
+        temperature = -45000;
+    if (temperature > 130000)
+        temperature = 130000;
+
+    /* 9 bit temperature: 2^9 * (T + 45) / 175, rounded */
+    value = ((temperature + 45000) * 512 + 87500) / 175000;
+    if (value > STS3X_ALERT_LIMIT_TEMPERATURE_MASK)
+        value = STS3X_ALERT_LIMIT_TEMPERATURE_MASK;
+
+    if (limit == STS3X_ALERT_LIMIT_HIGH_SET ||
+        limit == STS3X_ALERT_LIMIT_HIGH_CLEAR)
+        return (uint16_t)(STS3X_ALERT_LIMIT_HUMIDITY_MAX | value);
+    return (uint16_t)value;
+}
+
+static int32_t sts3x_decode_alert_limit(uint16_t value) {
+    return sts3x_ticks_to_milli_celsius(
+        (uint16_t)((value & STS3X_ALERT_LIMIT_TEMPERATURE_MASK)
+                   << STS3X_ALERT_LIMIT_TEMPERATURE_SHIFT));
+}
+
+static int16_t sts3x_set_alert_limit_unlocked(struct sts3x_dev* dev,
+                                              uint8_t limit,
+                                              int32_t temperature) {
+    uint16_t value;
+    int16_t ret;
+
+    if (limit > STS3X_ALERT_LIMIT_LOW_SET)
+        return STATUS_ERR_BAD_DATA;
+
+    ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    value = sts3x_encode_alert_limit(limit, temperature);
+    return sts3x_write_cmd_with_args(dev, STS3X_CMD_WRITE_ALERT_LIMIT[limit],
+                                     &value, 1);
+}
+
+int16_t sts3x_set_alert_limit_dev(struct sts3x_dev* dev, uint8_t limit,
+                                  int32_t temperature) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_set_alert_limit_unlocked(dev, limit, temperature);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+static int16_t sts3x_get_alert_limit_unlocked(struct sts3x_dev* dev,
+                                              uint8_t limit,
+                                              int32_t* temperature) {
+    uint16_t value;
+    int16_t ret;
+
+    if (limit > STS3X_ALERT_LIMIT_LOW_SET)
+        return STATUS_ERR_BAD_DATA;
+
+    ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    ret = sts3x_read_cmd(dev, STS3X_CMD_READ_ALERT_LIMIT[limit], &value, 1);
+    if (ret)
+        return ret;
+
+    *temperature = sts3x_decode_alert_limit(value);
+    return STATUS_OK;
+}
+
+int16_t sts3x_get_alert_limit_dev(struct sts3x_dev* dev, uint8_t limit,
+                                  int32_t* temperature) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_get_alert_limit_unlocked(dev, limit, temperature);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+static int16_t
+sts3x_set_alert_limits_unlocked(struct sts3x_dev* dev,
+                                const struct sts3x_alert_limits* limits) {
+    const int32_t values[] = {limits->high_set, limits->high_clear,
+                              limits->low_clear, limits->low_set};
+    int16_t ret;
+    uint8_t i;
+
+    if (limits->low_set > limits->low_clear ||
+        limits->low_clear >= limits->high_clear ||
+        limits->high_clear > limits->high_set)
+        return STATUS_ERR_BAD_DATA;
+
+    for (i = 0; i <= STS3X_ALERT_LIMIT_LOW_SET; ++i) {
+        ret = sts3x_set_alert_limit_unlocked(dev, i, values[i]);
+        if (ret)
+            return ret;
+    }
+    return STATUS_OK;
+}
+
+int16_t sts3x_set_alert_limits_dev(struct sts3x_dev* dev,
+                                   const struct sts3x_alert_limits* limits) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_set_alert_limits_unlocked(dev, limits);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+static int16_t
+sts3x_get_alert_limits_unlocked(struct sts3x_dev* dev,
+                                struct sts3x_alert_limits* limits) {
+    int32_t values[STS3X_ALERT_LIMIT_LOW_SET + 1];
+    int16_t ret;
+    uint8_t i;
+
+    for (i = 0; i <= STS3X_ALERT_LIMIT_LOW_SET; ++i) {
+        ret = sts3x_get_alert_limit_unlocked(dev, i, &values[i]);
+        if (ret)
+            return ret;
+    }
+    limits->high_set = values[STS3X_ALERT_LIMIT_HIGH_SET];
+    limits->high_clear = values[STS3X_ALERT_LIMIT_HIGH_CLEAR];
+    limits->low_clear = values[STS3X_ALERT_LIMIT_LOW_CLEAR];
+    limits->low_set = values[STS3X_ALERT_LIMIT_LOW_SET];
+    return STATUS_OK;
+}
+
+int16_t sts3x_get_alert_limits_dev(struct sts3x_dev* dev,
+                                   struct sts3x_alert_limits* limits) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_get_alert_limits_unlocked(dev, limits);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+static int16_t
+sts3x_start_alert_mode_unlocked(struct sts3x_dev* dev, uint8_t rate,
+                                const struct sts3x_alert_limits* limits) {
+    int16_t ret = sts3x_set_alert_limits_unlocked(dev, limits);
+    if (ret)
+        return ret;
+
+    /* pending alerts from before would keep the ALERT pin active */
+    ret = sts3x_clear_status_unlocked(dev);
+    if (ret)
+        return ret;
+
+    return sts3x_start_periodic_measurement_unlocked(dev, rate);
+}
+
+int16_t sts3x_start_alert_mode_dev(struct sts3x_dev* dev, uint8_t rate,
+                                   const struct sts3x_alert_limits* limits) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_start_alert_mode_unlocked(dev, rate, limits);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+#endif /* STS3X_DISABLE_ALERT */
+
+void sts3x_decode_status(uint16_t status, struct sts3x_status* decoded) {
+    decoded->alert_pending = (status & STS3X_STATUS_ALERT_PENDING) != 0;
+    decoded->heater_on = (status & STS3X_STATUS_HEATER_ON) != 0;
+    decoded->temperature_alert =
+        (status & STS3X_STATUS_TEMPERATURE_ALERT) != 0;
+    decoded->reset_detected = (status & STS3X_STATUS_RESET_DETECTED) != 0;
+    decoded->command_failed = (status & STS3X_STATUS_COMMAND_FAILED) != 0;
+    decoded->write_crc_failed = (status & STS3X_STATUS_WRITE_CRC_FAILED) != 0;
+}
+
+void sts3x_set_repeatability_dev(struct sts3x_dev* dev, uint8_t repeatability) {
+#ifdef STS3X_FIXED_REPEATABILITY
+    (void)dev;
+    (void)repeatability;
+#else
+    /* not while a measurement of another thread is in progress */
+    sts3x_lock_bus(dev);
+    switch (repeatability) {
+        case 2:
+        case 1:
+            dev->repeatability = repeatability;
+            break;
+        case 0:
+        default:
+            dev->repeatability = 0;
+            break;
+    }
+    sts3x_unlock_bus(dev);
+#endif /* STS3X_FIXED_REPEATABILITY */
+}
+
+#ifndef STS3X_DISABLE_HEATER
+static int16_t sts3x_heater_on_unlocked(struct sts3x_dev* dev) {
+    int16_t ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    ret = sts3x_write_cmd(dev, STS3X_CMD_HEATER_ON);
+    if (ret)
+        return ret;
+
+    dev->status |= STS3X_STATUS_HEATER_ON;
+    return STATUS_OK;
+}
+
+int16_t sts3x_heater_on_dev(struct sts3x_dev* dev) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_heater_on_unlocked(dev);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+#endif /* STS3X_DISABLE_HEATER */
+
+#ifndef STS3X_DISABLE_SERIAL
+static int16_t sts3x_read_serial_unlocked(struct sts3x_dev* dev,
+                                          uint32_t* serial) {
+    int16_t ret;
+    uint16_t serial_words[2];
+
+    ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    ret = sts3x_read_cmd(dev, STS3X_CMD_READ_SERIAL_ID, serial_words, 2);
+    if (ret)
+        return ret;
+
+    *serial = ((uint32_t)serial_words[0] << 16) | serial_words[1];
+    return STATUS_OK;
+}
+
+int16_t sts3x_read_serial_dev(struct sts3x_dev* dev, uint32_t* serial) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_read_serial_unlocked(dev, serial);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+#endif /* STS3X_DISABLE_SERIAL */
+
+#ifndef STS3X_DISABLE_DISCOVERY
+void sts3x_init_discovered_dev(struct sts3x_dev* dev,
+                               struct sts3x_i2c_mux_channel* mux_channel,
+                               const struct sts3x_discovered_sensor* sensor) {
+    sts3x_init_dev(dev, sensor->address);
+    if (sensor->mux_address != STS3X_DISCOVERY_NO_MUX) {
+        mux_channel->mux_address = sensor->mux_address;
+        mux_channel->channel = sensor->mux_channel;
+        dev->select_bus = sts3x_select_i2c_mux_channel;
+        dev->bus = mux_channel;
+    }
+}
+
+static int16_t sts3x_disable_i2c_mux(uint8_t mux_address) {
+    const uint8_t no_channels = 0;
+
+    return sensirion_i2c_write(mux_address, &no_channels, 1) ? STATUS_NACK
+                                                             : STATUS_OK;
+}
+
+/**
+ * Probes all sensor addresses on the currently enabled bus and appends the
+ * responding ones to the table, except for the addresses in skip.
+ *
+ * @return the responding addresses as bits of STS3X_DISCOVERY_ADDRESSES
+ */
+static uint8_t sts3x_discovery_probe(struct sts3x_discovery_table* table,
+                                     uint8_t mux_address, uint8_t mux_channel,
+                                     uint8_t skip, uint8_t* overflow) {
+    struct sts3x_discovered_sensor* sensor;
+    struct sts3x_dev dev;
+    uint8_t found = 0;
+    uint8_t i;
+
+    for (i = 0; i < sizeof(STS3X_DISCOVERY_ADDRESSES); ++i) {
+        if (skip & (1 << i))
+            continue;
+        sts3x_init_dev(&dev, STS3X_DISCOVERY_ADDRESSES[i]);
+        if (sts3x_i2c_probe_address(&dev) != STATUS_OK)
+            continue;
+
+        found |= (uint8_t)(1 << i);
+        if (table->count == STS3X_DISCOVERY_MAX_SENSORS) {
+            *overflow = 1;
+            continue;
+        }
+        sensor = &table->sensors[table->count++];
+        sensor->serial = 0;
+        sensor->address = STS3X_DISCOVERY_ADDRESSES[i];
+        sensor->mux_address = mux_address;
+        sensor->mux_channel = mux_channel;
+    }
+    return found;
+}
+
+/**
+ * Makes the sensor reachable. The table is ordered by multiplexer and channel,
+ * so the multiplexer is only switched when the channel changes and the channel
+ * of the previous multiplexer is disabled when the multiplexer changes.
+ */
+static int16_t
+sts3x_discovery_select(const struct sts3x_discovered_sensor* sensor,
+                       const struct sts3x_discovered_sensor* previous) {
+    struct sts3x_i2c_mux_channel mux_channel;
+
+    if (previous && previous->mux_address == sensor->mux_address &&
+        previous->mux_channel == sensor->mux_channel)
+        return STATUS_OK;
+    if (previous && previous->mux_address != STS3X_DISCOVERY_NO_MUX &&
+        previous->mux_address != sensor->mux_address)
+        sts3x_disable_i2c_mux(previous->mux_address);
+    if (sensor->mux_address == STS3X_DISCOVERY_NO_MUX)
+        return STATUS_OK;
+
+    mux_channel.mux_address = sensor->mux_address;
+    mux_channel.channel = sensor->mux_channel;
+    return sts3x_select_i2c_mux_channel(&mux_channel) ? STATUS_NACK
+                                                      : STATUS_OK;
+}
+
+/**
+ * Reads the serial numbers of all sensors in the table with a single command
+ * wait and removes the entries which do not answer with a valid serial number,
+ * e.g. other devices at the same address.
+ */
+static void sts3x_discovery_read_serials(struct sts3x_discovery_table* table) {
+    struct sts3x_discovered_sensor* sensors = table->sensors;
+    const struct sts3x_discovered_sensor* previous = NULL;
+    uint8_t sent[STS3X_DISCOVERY_MAX_SENSORS];
+    struct sts3x_i2c_mux_channel mux_channel;
+    struct sts3x_dev dev;
+    uint16_t words[2];
+    uint16_t count = 0;
+    uint16_t i;
+    int16_t ret;
+
+    for (i = 0; i < table->count; ++i) {
+        sts3x_init_dev(&dev, sensors[i].address);
+        sent[i] = sts3x_discovery_select(&sensors[i], previous) == STATUS_OK &&
+                  sts3x_i2c_write_cmd(&dev, STS3X_CMD_READ_SERIAL_ID, NULL,
+                                      0) == STATUS_OK;
+        previous = &sensors[i];
+    }
+    if (table->count)
+        sensirion_sleep_usec(STS3X_CMD_DURATION_USEC);
+
+    for (i = 0; i < table->count; ++i) {
+        sts3x_init_dev(&dev, sensors[i].address);
+        ret = sts3x_discovery_select(&sensors[i], previous);
+        previous = &sensors[i];
+        if (ret == STATUS_OK)
+            ret = sent[i] ? sts3x_i2c_read_words(&dev, words, 2) : STATUS_NACK;
+        if (ret == STATUS_OK) {
+            sensors[i].serial = ((uint32_t)words[0] << 16) | words[1];
+        } else {
+            /* e.g. a disturbed response, read it once more on its own */
+            sts3x_init_discovered_dev(&dev, &mux_channel, &sensors[i]);
+            ret = sts3x_read_serial_unlocked(&dev, &sensors[i].serial);
+        }
+        if (ret == STATUS_OK)
+            sensors[count++] = sensors[i];
+    }
+    if (previous && previous->mux_address != STS3X_DISCOVERY_NO_MUX)
+        sts3x_disable_i2c_mux(previous->mux_address);
+    table->count = count;
+}
+
+static uint8_t sts3x_discovery_crc_update(uint8_t crc, const uint8_t* data,
+                                          uint16_t count) {
+    uint16_t i;
+    uint8_t bit;
+
+    for (i = 0; i < count; ++i) {
+        crc ^= data[i];
+        for (bit = 0; bit < 8; ++bit)
+            crc = crc & 0x80 ? (uint8_t)(crc << 1) ^ CRC8_POLYNOMIAL
+                             : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+/* CRC of the table contents, independent of the struct layout */
+static uint8_t
+sts3x_discovery_table_crc(const struct sts3x_discovery_table* table) {
+    const struct sts3x_discovered_sensor* sensor;
+    uint8_t data[7];
+    uint8_t crc;
+    uint16_t i;
+
+    data[0] = (uint8_t)(table->count >> 8);
+    data[1] = (uint8_t)table->count;
+    crc = sts3x_discovery_crc_update(CRC8_INIT, data, 2);
+    for (i = 0; i < table->count && i < STS3X_DISCOVERY_MAX_SENSORS; ++i) {
+        sensor = &table->sensors[i];
+        data[0] = (uint8_t)(sensor->serial >> 24);
+        data[1] = (uint8_t)(sensor->serial >> 16);
+        data[2] = (uint8_t)(sensor->serial >> 8);
+        data[3] = (uint8_t)sensor->serial;
+        data[4] = sensor->address;
+        data[5] = sensor->mux_address;
+        data[6] = sensor->mux_channel;
+        crc = sts3x_discovery_crc_update(crc, data, sizeof(data));
+    }
+    return crc;
+}
+
+int16_t sts3x_discover(const uint8_t* mux_addresses, uint8_t num_muxes,
+                       struct sts3x_discovery_table* table) {
+    struct sts3x_i2c_mux_channel mux_channel;
+    int16_t ret = STATUS_OK;
+    uint8_t overflow = 0;
+    uint8_t direct;
+    uint8_t m;
+
+    table->count = 0;
+
+    /* with all channels disabled, only sensors directly on the bus respond */
+    for (m = 0; m < num_muxes; ++m)
+        sts3x_disable_i2c_mux(mux_addresses[m]);
+    direct = sts3x_discovery_probe(table, STS3X_DISCOVERY_NO_MUX, 0, 0,
+                                   &overflow);
+
+    for (m = 0; m < num_muxes; ++m) {
+        mux_channel.mux_address = mux_addresses[m];
+        for (mux_channel.channel = 0; mux_channel.channel < STS3X_MUX_CHANNELS;
+             ++mux_channel.channel) {
+            if (sts3x_select_i2c_mux_channel(&mux_channel)) {
+                /* report the multiplexer, but scan the other ones */
+                ret = STATUS_NACK;
+                break;
+            }
+            sts3x_discovery_probe(table, mux_channel.mux_address,
+                                  mux_channel.channel, direct, &overflow);
+        }
+        sts3x_disable_i2c_mux(mux_addresses[m]);
+    }
+
+    sts3x_discovery_read_serials(table);
+    table->crc = sts3x_discovery_table_crc(table);
+    if (ret)
+        return ret;
+    return overflow ? STATUS_ERR_BAD_DATA : STATUS_OK;
+}
+
+uint8_t
+sts3x_discovery_table_is_valid(const struct sts3x_discovery_table* table) {
+    return table->count <= STS3X_DISCOVERY_MAX_SENSORS &&
+           table->crc == sts3x_discovery_table_crc(table);
+}
+
+int16_t sts3x_discovery_verify(const struct sts3x_discovery_table* table) {
+    const struct sts3x_discovered_sensor* previous = NULL;
+    struct sts3x_dev dev;
+    int16_t ret = STATUS_OK;
+    uint16_t i;
+
+    for (i = 0; i < table->count && ret == STATUS_OK; ++i) {
+        sts3x_init_dev(&dev, table->sensors[i].address);
+        ret = sts3x_discovery_select(&table->sensors[i], previous);
+        if (ret == STATUS_OK)
+            ret = sts3x_i2c_probe_address(&dev);
+        previous = &table->sensors[i];
+    }
+    if (previous && previous->mux_address != STS3X_DISCOVERY_NO_MUX)
+        sts3x_disable_i2c_mux(previous->mux_address);
+    return ret;
+}
+
+int16_t sts3x_discover_cached(const uint8_t* mux_addresses, uint8_t num_muxes,
+                              struct sts3x_discovery_table* table,
+                              uint8_t* rescanned) {
+    *rescanned = 0;
+    if (sts3x_discovery_table_is_valid(table) &&
+        sts3x_discovery_verify(table) == STATUS_OK)
+        return STATUS_OK;
+
+    *rescanned = 1;
+    return sts3x_discover(mux_addresses, num_muxes, table);
+}
+#endif /* STS3X_DISABLE_DISCOVERY */
+
+#ifndef STS3X_DISABLE_HEATER
+static int16_t sts3x_heater_off_unlocked(struct sts3x_dev* dev) {
+    int16_t ret = sts3x_select_dev(dev);
+    if (ret)
+        return ret;
+
+    ret = sts3x_write_cmd(dev, STS3X_CMD_HEATER_OFF);
+    if (ret)
+        return ret;
+
+    dev->status &= (uint16_t)~STS3X_STATUS_HEATER_ON;
+    return STATUS_OK;
+}
+
+int16_t sts3x_heater_off_dev(struct sts3x_dev* dev) {
+    int16_t ret;
+
+    sts3x_lock_bus(dev);
+    ret = sts3x_heater_off_unlocked(dev);
+    sts3x_unlock_bus(dev);
+    return ret;
+}
+
+void sts3x_self_test_init(struct sts3x_self_test* test, struct sts3x_dev* dev,
+                          const struct sts3x_self_test_config* config) {
+    test->dev = dev;
+    test->config = config;
+    test->result = STATUS_IN_PROGRESS;
+    test->baseline = 0;
+    test->increase = 0;
+    test->duration_usec = 0;
+    test->state = STS3X_SELF_TEST_STATE_IDLE;
+    test->heater_off_attempts = 0;
+    test->outcome = STATUS_OK;
+    test->started_at_usec = 0;
+    test->due_at_usec = 0;
+}
+
+static void sts3x_self_test_finish(struct sts3x_self_test* test,
+                                   sts3x_clock_usec_fn clock, int16_t result) {
+    test->state = STS3X_SELF_TEST_STATE_DONE;
+    test->result = result;
+    test->duration_usec = clock() - test->started_at_usec;
+}
+
+/* all paths after the heater on command end here */
+static void sts3x_self_test_heater_off(struct sts3x_self_test* test,
+                                       sts3x_clock_usec_fn clock) {
+    int16_t ret = sts3x_heater_off_unlocked(test->dev);
+
+    test->state = STS3X_SELF_TEST_STATE_HEATER_OFF;
+    if (ret == STATUS_OK) {
+        sts3x_self_test_finish(test, clock, test->outcome);
+    } else if (++test->heater_off_attempts >=
+               STS3X_SELF_TEST_HEATER_OFF_ATTEMPTS) {
+        sts3x_self_test_finish(test, clock, ret);
+    } else {
+        test->due_at_usec = clock() + STS3X_CMD_DURATION_USEC;
+    }
+}
+
+static void sts3x_self_test_stop(struct sts3x_self_test* test,
+                                 sts3x_clock_usec_fn clock, int16_t outcome) {
+    test->outcome = outcome;
+    sts3x_self_test_heater_off(test, clock);
+}
+
+/* schedules the next heated measurement if it still fits into the budget */
+static void sts3x_self_test_schedule(struct sts3x_self_test* test,
+                                     sts3x_clock_usec_fn clock) {
+    const struct sts3x_self_test_config* config = test->config;
+    const uint32_t now = clock();
+
+    /* the transactions and turning the heater off take about a command */
+    if (now - test->started_at_usec + config->check_interval_usec +
+            sts3x_get_measurement_duration_usec_dev(test->dev) +
+            STS3X_CMD_DURATION_USEC >
+        config->budget_usec)
+        sts3x_self_test_stop(test, clock, STATUS_SELF_TEST_FAILED);
+    else
+        test->due_at_usec = now + config->check_interval_usec;
+}
+
+static void sts3x_self_test_step(struct sts3x_self_test* test,
+                                 sts3x_clock_usec_fn clock) {
+    const struct sts3x_self_test_config* config = test->config;
+    struct sts3x_dev* dev = test->dev;
+    int32_t temperature;
+    uint32_t ready_at;
+    int16_t ret;
+
+    switch (test->state) {
+        case STS3X_SELF_TEST_STATE_IDLE:
+            test->started_at_usec = clock();
+            if (dev->mode != STS3X_MODE_SINGLE_SHOT) {
+                sts3x_self_test_finish(test, clock, STATUS_ERR_BAD_DATA);
+                return;
+            }
+            test->state = STS3X_SELF_TEST_STATE_BASELINE;
+            /* fall through */
+        case STS3X_SELF_TEST_STATE_BASELINE:
+            ret = sts3x_measure_poll_unlocked(dev, clock, &temperature,
+                                              &ready_at);
+            if (ret == STATUS_IN_PROGRESS) {
+                test->due_at_usec = ready_at;
+            } else if (ret) {
+                sts3x_self_test_finish(test, clock, ret);
+            } else {
+                test->baseline = temperature;
+                test->state = STS3X_SELF_TEST_STATE_HEATING;
+                ret = sts3x_heater_on_unlocked(dev);
+                if (ret)
+                    sts3x_self_test_stop(test, clock, ret);
+                else
+                    sts3x_self_test_schedule(test, clock);
+            }
+            return;
+
+        case STS3X_SELF_TEST_STATE_HEATING:
+            ret = sts3x_measure_poll_unlocked(dev, clock, &temperature,
+                                              &ready_at);
+            if (ret == STATUS_IN_PROGRESS) {
+                test->due_at_usec = ready_at;
+                return;
+            }
+            if (ret) {
+                sts3x_self_test_stop(test, clock, ret);
+                return;
+            }
+
+            test->increase = temperature - test->baseline;
+            if (test->increase >= config->min_increase)
+                sts3x_self_test_stop(test, clock, STATUS_OK);
+            else
+                sts3x_self_test_schedule(test, clock);
+            return;
+
+        case STS3X_SELF_TEST_STATE_HEATER_OFF:
+            sts3x_self_test_heater_off(test, clock);
+            return;
+
+        default:
+            return;
+    }
+}
+
+int16_t sts3x_self_test_poll(struct sts3x_self_test* tests, uint16_t num_tests,
+                             sts3x_clock_usec_fn clock,
+                             uint32_t* next_due_usec) {
+    struct sts3x_self_test* test;
+    uint8_t running = 0;
+    int16_t ret = STATUS_OK;
+    uint32_t now;
+    uint16_t i;
+
+    for (i = 0; i < num_tests; ++i) {
+        test = &tests[i];
+        if (test->state == STS3X_SELF_TEST_STATE_DONE)
+            continue;
+        /* signed difference to handle the wrap around of the clock */
+        if (test->state == STS3X_SELF_TEST_STATE_IDLE ||
+            (int32_t)(clock() - test->due_at_usec) >= 0) {
+            sts3x_lock_bus(test->dev);
+            sts3x_self_test_step(test, clock);
+            sts3x_unlock_bus(test->dev);
+        }
+    }
+
+    now = clock();
+    for (i = 0; i < num_tests; ++i) {
+        test = &tests[i];
+        if (test->state != STS3X_SELF_TEST_STATE_DONE) {
+            if (!running ||
+                (int32_t)(test->due_at_usec - *next_due_usec) < 0)
+                *next_due_usec = test->due_at_usec;
+            running = 1;
+        } else if (test->result != STATUS_OK && ret == STATUS_OK) {
+            ret = test->result;
+        }
+    }
+    if (running) {
+        if ((int32_t)(*next_due_usec - now) < 0)
+            *next_due_usec = now;
+        return STATUS_IN_PROGRESS;
+    }
+    return ret;
+}
+
+int16_t sts3x_self_test_run(struct sts3x_self_test* tests, uint16_t num_tests,
+                            sts3x_clock_usec_fn clock) {
+    uint32_t next_due_usec;
+    int32_t wait_usec;
+    int16_t ret;
+
+    while ((ret = sts3x_self_test_poll(tests, num_tests, clock,
+                                       &next_due_usec)) ==
+           STATUS_IN_PROGRESS) {
+        wait_usec = (int32_t)(next_due_usec - clock());
+        if (wait_usec > 0)
+            sensirion_sleep_usec((uint32_t)wait_usec);
+    }
+    return ret;
+}
+#endif /* STS3X_DISABLE_HEATER */
+
+#ifndef STS3X_DISABLE_RETRY
+void sts3x_set_retry_policy_dev(struct sts3x_dev* dev,
+                                const struct sts3x_retry_policy* policy) {
+    dev->retry_policy = policy;
+    dev->consecutive_failures = 0;
+}
+#endif /* STS3X_DISABLE_RETRY */
+
+void sts3x_set_bus_lock_dev(struct sts3x_dev* dev,
+                            const struct sts3x_bus_lock* lock) {
+    dev->bus_lock = lock;
+}
+
+#ifndef STS3X_DISABLE_CONVERSION
+void sts3x_set_conversion_dev(struct sts3x_dev* dev, sts3x_convert_fn convert,
+                              const void* calibration) {
+    dev->convert = convert;
+    dev->calibration = calibration;
+}
+#endif /* STS3X_DISABLE_CONVERSION */
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+void sts3x_set_instrumentation_dev(struct sts3x_dev* dev,
+                                   sts3x_clock_usec_fn clock,
+                                   sts3x_transaction_hook_fn hook) {
+    dev->clock = clock;
+    dev->transaction_hook = hook;
+}
+
+void sts3x_get_stats_dev(const struct sts3x_dev* dev,
+                         struct sts3x_stats* stats) {
+    *stats = dev->stats;
+    if (stats->latency_min_usec == STS3X_LATENCY_MIN_UNSET)
+        stats->latency_min_usec = 0;
+    if (stats->transactions)
+        stats->latency_mean_usec =
+            (uint32_t)(stats->latency_total_usec / stats->transactions);
+}
+
+void sts3x_reset_stats_dev(struct sts3x_dev* dev) {
+    struct sts3x_stats* stats = &dev->stats;
+
+    stats->transactions = 0;
+    stats->nacks = 0;
+    stats->crc_errors = 0;
+    stats->retries = 0;
+    stats->latency_min_usec = STS3X_LATENCY_MIN_UNSET;
+    stats->latency_max_usec = 0;
+    stats->latency_mean_usec = 0;
+    stats->latency_total_usec = 0;
+}
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+
+/* default instance, compatible with single sensor setups */
+
+int16_t sts3x_measure_blocking_read(int32_t* temperature) {
+    return sts3x_measure_blocking_read_dev(&sts3x_default_dev, temperature);
+}
+
+int16_t sts3x_measure_polling_read(int32_t* temperature) {
+    return sts3x_measure_polling_read_dev(&sts3x_default_dev, temperature);
+}
+
+int16_t sts3x_measure_poll(sts3x_clock_usec_fn clock, int32_t* temperature,
+                           uint32_t* ready_at_usec) {
+    return sts3x_measure_poll_dev(&sts3x_default_dev, clock, temperature,
+                                  ready_at_usec);
+}
+
+int16_t sts3x_measure() {
+    return sts3x_measure_dev(&sts3x_default_dev);
+}
+
+uint32_t sts3x_get_measurement_duration_usec(void) {
+    return sts3x_get_measurement_duration_usec_dev(&sts3x_default_dev);
+}
+
+int16_t sts3x_read(int32_t* temperature) {
+    return sts3x_read_dev(&sts3x_default_dev, temperature);
+}
+
+int16_t sts3x_read_ticks(uint16_t* ticks) {
+    return sts3x_read_ticks_dev(&sts3x_default_dev, ticks);
+}
+
+#ifndef STS3X_DISABLE_PERIODIC
+int16_t sts3x_fetch_ticks(uint16_t* ticks) {
+    return sts3x_fetch_ticks_dev(&sts3x_default_dev, ticks);
+}
+
+int16_t sts3x_start_periodic_measurement(uint8_t rate) {
+    return sts3x_start_periodic_measurement_dev(&sts3x_default_dev, rate);
+}
+
+int16_t sts3x_fetch_data(int32_t* temperature) {
+    return sts3x_fetch_data_dev(&sts3x_default_dev, temperature);
+}
+
+int16_t sts3x_periodic_blocking_read(int32_t* temperature) {
+    return sts3x_periodic_blocking_read_dev(&sts3x_default_dev, temperature);
+}
+
+int16_t sts3x_fetch_timestamped(sts3x_clock_usec_fn clock, int32_t* temperature,
+                                uint32_t* timestamp_usec,
+                                uint32_t* ready_at_usec) {
+    return sts3x_fetch_timestamped_dev(&sts3x_default_dev, clock, temperature,
+                                       timestamp_usec, ready_at_usec);
+}
+
+int16_t sts3x_stop_periodic_measurement(void) {
+    return sts3x_stop_periodic_measurement_dev(&sts3x_default_dev);
+}
+#endif /* STS3X_DISABLE_PERIODIC */
+
+int16_t sts3x_probe() {
+    return sts3x_probe_dev(&sts3x_default_dev);
+}
+
+void sts3x_set_repeatability(uint8_t repeatability) {
+    sts3x_set_repeatability_dev(&sts3x_default_dev, repeatability);
+}
+
+#ifndef STS3X_DISABLE_HEATER
+int16_t sts3x_heater_on(void) {
+    return sts3x_heater_on_dev(&sts3x_default_dev);
+}
+#endif /* STS3X_DISABLE_HEATER */
+
+#ifndef STS3X_DISABLE_SERIAL
+int16_t sts3x_read_serial(uint32_t* serial) {
+    return sts3x_read_serial_dev(&sts3x_default_dev, serial);
+}
+#endif /* STS3X_DISABLE_SERIAL */
+
+#ifndef STS3X_DISABLE_HEATER
+int16_t sts3x_heater_off(void) {
+    return sts3x_heater_off_dev(&sts3x_default_dev);
+}
+#endif /* STS3X_DISABLE_HEATER */
+
+int16_t sts3x_read_status(uint16_t* status) {
+    return sts3x_read_status_dev(&sts3x_default_dev, status);
+}
+
+int16_t sts3x_clear_status(void) {
+    return sts3x_clear_status_dev(&sts3x_default_dev);
+}
+
+int16_t sts3x_get_cached_status(uint16_t* status) {
+    return sts3x_get_cached_status_dev(&sts3x_default_dev, status);
+}
+
+#ifndef STS3X_DISABLE_ALERT
+int16_t sts3x_set_alert_limits(const struct sts3x_alert_limits* limits) {
+    return sts3x_set_alert_limits_dev(&sts3x_default_dev, limits);
+}
+
+int16_t sts3x_get_alert_limits(struct sts3x_alert_limits* limits) {
+    return sts3x_get_alert_limits_dev(&sts3x_default_dev, limits);
+}
+
+int16_t sts3x_start_alert_mode(uint8_t rate,
+                               const struct sts3x_alert_limits* limits) {
+    return sts3x_start_alert_mode_dev(&sts3x_default_dev, rate, limits);
+}
+#endif /* STS3X_DISABLE_ALERT */
+
+#ifndef STS3X_DISABLE_RETRY
+void sts3x_set_retry_policy(const struct sts3x_retry_policy* policy) {
+    sts3x_set_retry_policy_dev(&sts3x_default_dev, policy);
+}
+#endif /* STS3X_DISABLE_RETRY */
+
+void sts3x_set_bus_lock(const struct sts3x_bus_lock* lock) {
+    sts3x_set_bus_lock_dev(&sts3x_default_dev, lock);
+}
+
+#ifndef STS3X_DISABLE_CONVERSION
+void sts3x_set_conversion(sts3x_convert_fn convert, const void* calibration) {
+    sts3x_set_conversion_dev(&sts3x_default_dev, convert, calibration);
+}
+#endif /* STS3X_DISABLE_CONVERSION */
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+void sts3x_set_instrumentation(sts3x_clock_usec_fn clock,
+                               sts3x_transaction_hook_fn hook) {
+    sts3x_set_instrumentation_dev(&sts3x_default_dev, clock, hook);
+}
+
+void sts3x_get_stats(struct sts3x_stats* stats) {
+    sts3x_get_stats_dev(&sts3x_default_dev, stats);
+}
+
+void sts3x_reset_stats(void) {
+    sts3x_reset_stats_dev(&sts3x_default_dev);
 }
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
 
 const char* sts3x_get_driver_version() {
     return STS_DRV_VERSION_STR;
 }
 
 uint8_t sts3x_get_configured_address() {
-    return STS3X_ADDRESS;
+    return sts3x_default_dev.address;
 }
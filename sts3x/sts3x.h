@@ -49,17 +49,336 @@
 extern "C" {
 #endif
 
+/*
+ * Compile-time configuration, usually set by a profile (see profiles/ and
+ * STS3X_PROFILE in user_config.inc). By default, everything is configurable at
+ * run time and all features are available.
+ *
+ * STS3X_FIXED_REPEATABILITY    0, 1 or 2: the repeatability of all sensors,
+ *                              sts3x_set_repeatability() has no effect
+ * STS3X_FIXED_ADDRESS          the I2C address of all sensors
+ * STS3X_DISABLE_HEATER         removes sts3x_heater_on/off() and the
+ *                              self-test
+ * STS3X_DISABLE_SERIAL         removes sts3x_read_serial(), implies
+ *                              STS3X_DISABLE_DISCOVERY
+ * STS3X_DISABLE_DISCOVERY      removes sts3x_discover() and related functions
+ * STS3X_DISABLE_PERIODIC       removes the periodic measurement mode, implies
+ *                              STS3X_DISABLE_ALERT
+ * STS3X_DISABLE_ALERT          removes the alert limits and alert mode
+ * STS3X_DISABLE_RETRY          removes the retry policy and bus recovery
+ * STS3X_DISABLE_CONVERSION     removes sts3x_set_conversion_dev(), all sensors
+ *                              use the standard conversion
+ */
+#if defined(STS3X_DISABLE_PERIODIC) && !defined(STS3X_DISABLE_ALERT)
+#define STS3X_DISABLE_ALERT
+#endif
+#if defined(STS3X_DISABLE_SERIAL) && !defined(STS3X_DISABLE_DISCOVERY)
+#define STS3X_DISABLE_DISCOVERY
+#endif
+
 #define STATUS_OK 0
 #define STATUS_ERR_BAD_DATA (-1)
 #define STATUS_CRC_FAIL (-2)
 #define STATUS_UNKNOWN_DEVICE (-3)
+#define STATUS_NACK (-4)      /* the sensor did not acknowledge */
+#define STATUS_BUS_RESET (-5) /* failed, the bus and sensors were reset */
+#define STATUS_SELF_TEST_FAILED (-6) /* see sts3x_self_test_poll() */
+#define STATUS_IN_PROGRESS 1
 
 #define STS3X_MEASUREMENT_DURATION_USEC 15500
 
+#define STS3X_MEASUREMENT_RATE_0_5_MPS 0
+#define STS3X_MEASUREMENT_RATE_1_MPS 1
+#define STS3X_MEASUREMENT_RATE_2_MPS 2
+#define STS3X_MEASUREMENT_RATE_4_MPS 3
+#define STS3X_MEASUREMENT_RATE_10_MPS 4
+/* 4 mps with accelerated response time (ART), independent of repeatability */
+#define STS3X_MEASUREMENT_RATE_ART 5
+
+#define STS3X_ADDRESS_DEFAULT 0x4A
+#define STS3X_ADDRESS_ALTERNATE 0x4B
+
+#define STS3X_MODE_SINGLE_SHOT 0
+#define STS3X_MODE_PERIODIC 1
+
+/* alert limits, see struct sts3x_alert_limits */
+#define STS3X_ALERT_LIMIT_HIGH_SET 0
+#define STS3X_ALERT_LIMIT_HIGH_CLEAR 1
+#define STS3X_ALERT_LIMIT_LOW_CLEAR 2
+#define STS3X_ALERT_LIMIT_LOW_SET 3
+
+/* status register bits, see sts3x_read_status() */
+#define STS3X_STATUS_ALERT_PENDING 0x8000
+#define STS3X_STATUS_HEATER_ON 0x2000
+#define STS3X_STATUS_TEMPERATURE_ALERT 0x0400
+#define STS3X_STATUS_RESET_DETECTED 0x0010
+#define STS3X_STATUS_COMMAND_FAILED 0x0002
+#define STS3X_STATUS_WRITE_CRC_FAILED 0x0001
+
+/**
+ * Selects the bus a sensor is attached to, e.g. by switching an I2C multiplexer
+ * channel. Called with the bus handle of the sensor before it is accessed.
+ *
+ * @param bus   the bus handle of the sensor (see struct sts3x_dev)
+ * @return      0 if the bus was selected, else an error code.
+ */
+typedef int16_t (*sts3x_select_bus_fn)(void* bus);
+
+/**
+ * Monotonic clock used by the non-blocking measurement functions.
+ *
+ * @return  the current time in microseconds. The value may wrap around.
+ */
+typedef uint32_t (*sts3x_clock_usec_fn)(void);
+
+/**
+ * Recovers a stuck bus, e.g. by toggling SCL until SDA is released.
+ *
+ * @param bus   the bus handle of the sensor (see struct sts3x_dev)
+ * @return      0 if the bus was cleared, else an error code.
+ */
+typedef int16_t (*sts3x_bus_clear_fn)(void* bus);
+
+#ifndef STS3X_DISABLE_CONVERSION
+/**
+ * Converts the raw temperature signal of a sensor instead of the standard
+ * formula, e.g. with per sensor calibration coefficients, see
+ * sts3x_set_conversion_dev().
+ *
+ * @param ticks         the raw temperature signal S_T
+ * @param calibration   the calibration of the sensor (see struct sts3x_dev)
+ * @return              the temperature in milli degree Celsius
+ */
+typedef int32_t (*sts3x_convert_fn)(uint16_t ticks, const void* calibration);
+#endif /* STS3X_DISABLE_CONVERSION */
+
+/**
+ * Handling of transient I2C failures, see sts3x_set_retry_policy_dev().
+ *
+ * Failed transactions are retried individually, e.g. only the read out of a
+ * measurement result instead of the whole measurement, waiting backoff_usec
+ * before the first retry and twice as long before each further retry. If
+ * recovery_threshold transactions in a row fail despite the retries, the bus is
+ * recovered: bus_clear is called if set, then the sensor is reset with a soft
+ * reset and the function returns STATUS_BUS_RESET. The sensor is in single
+ * shot mode with the heater off afterwards. Other sensors on the same bus are
+ * not reset and keep their state.
+ */
+struct sts3x_retry_policy {
+    uint8_t max_retries;          /* retries per transaction */
+    uint8_t recovery_threshold;   /* failures until recovery, 0 for never */
+    uint16_t backoff_usec;        /* wait before the first retry */
+    uint16_t max_backoff_usec;    /* upper bound of the wait */
+    sts3x_bus_clear_fn bus_clear; /* NULL to only reset the sensor */
+};
+
+/**
+ * Acquires or releases a lock, see struct sts3x_bus_lock.
+ *
+ * @param context   the context of the lock
+ */
+typedef void (*sts3x_lock_fn)(void* context);
+
+/**
+ * Lock of an I2C bus for hosts where several threads use the driver, see
+ * sts3x_set_bus_lock_dev().
+ *
+ * The driver holds the lock across each complete command sequence with a
+ * sensor, including the bus selection and the wait for a measurement result.
+ * Use one lock for all sensors on the same bus (also behind a multiplexer).
+ * The I2C HAL has no bus argument and the sample implementations drive a
+ * single bus, so with them all sensors share one lock. Different locks for
+ * different buses are only safe with a HAL which is thread-safe per bus,
+ * e.g. one which keeps the bus chosen by select_bus per thread. The lock does
+ * not need to be recursive. Use a fair lock (e.g. a ticket lock) so that
+ * threads are served in order.
+ */
+struct sts3x_bus_lock {
+    sts3x_lock_fn lock;   /* blocks until the bus is available */
+    sts3x_lock_fn unlock; /* releases the bus */
+    void* context;        /* passed to lock and unlock, e.g. a mutex */
+};
+
+/* suitable for most setups, recovers from failures within a few milliseconds */
+#define STS3X_RETRY_POLICY_DEFAULT \
+    { 3, 3, 500, 4000, NULL }
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+#define STS3X_TRANSACTION_WRITE 0
+#define STS3X_TRANSACTION_READ 1
+#define STS3X_TRANSACTION_WRITE_READ 2 /* see USE_SENSIRION_I2C_TRANSFER */
+
+struct sts3x_dev;
+
+/**
+ * Called after every I2C transaction of the driver with a sensor if the driver
+ * is compiled with STS3X_ENABLE_INSTRUMENTATION.
+ *
+ * @param dev           the sensor instance
+ * @param direction     one of STS3X_TRANSACTION_*
+ * @param num_bytes     the number of bytes written or read
+ * @param result        0 if the transaction succeeded, else an error code
+ *                      (STATUS_CRC_FAIL if the response has a wrong CRC)
+ * @param duration_usec the duration of the transaction, 0 if no clock is set
+ */
+typedef void (*sts3x_transaction_hook_fn)(const struct sts3x_dev* dev,
+                                          uint8_t direction, uint16_t num_bytes,
+                                          int16_t result,
+                                          uint32_t duration_usec);
+
+/**
+ * Per sensor bus statistics, see sts3x_get_stats_dev(). The latencies are only
+ * recorded if a clock is set with sts3x_set_instrumentation_dev().
+ */
+struct sts3x_stats {
+    uint32_t transactions;       /* I2C transactions incl. failed ones */
+    uint32_t nacks;              /* transactions not acknowledged */
+    uint32_t crc_errors;         /* responses with a wrong CRC */
+    uint32_t retries;            /* repeated read outs, e.g. while polling */
+    uint32_t latency_min_usec;   /* shortest transaction */
+    uint32_t latency_max_usec;   /* longest transaction */
+    uint32_t latency_mean_usec;  /* average transaction duration */
+    uint64_t latency_total_usec; /* sum of all transaction durations */
+};
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+
+/**
+ * Sensor instance for setups with more than one sensor. Initialize it with
+ * sts3x_init_dev() and pass it to the *_dev() variants of the driver functions.
+ * The functions without the _dev suffix operate on a default instance at the
+ * configured address (see sts3x_get_configured_address()).
+ */
+struct sts3x_dev {
+    uint8_t address;                /* I2C address of the sensor */
+    uint8_t repeatability;          /* see sts3x_set_repeatability() */
+    uint8_t mode;                   /* STS3X_MODE_SINGLE_SHOT or _PERIODIC */
+    uint8_t periodic_rate;          /* one of STS3X_MEASUREMENT_RATE_* */
+    sts3x_select_bus_fn select_bus; /* NULL if the sensor is always reachable */
+    void* bus;                      /* bus handle passed to select_bus */
+    /* see sts3x_measure_poll() and sts3x_fetch_timestamped() */
+    uint8_t measurement_pending;
+    uint32_t ready_at_usec;
+    /* NULL for no retries, see sts3x_set_retry_policy_dev() */
+    const struct sts3x_retry_policy* retry_policy;
+    uint8_t consecutive_failures; /* see struct sts3x_retry_policy */
+    uint16_t status;              /* see sts3x_get_cached_status() */
+    uint8_t status_valid;         /* 1 once status was read */
+    /* NULL for single threaded use, see sts3x_set_bus_lock_dev() */
+    const struct sts3x_bus_lock* bus_lock;
+#ifndef STS3X_DISABLE_CONVERSION
+    /* NULL for the standard conversion, see sts3x_set_conversion_dev() */
+    sts3x_convert_fn convert;
+    const void* calibration; /* passed to convert */
+#endif /* STS3X_DISABLE_CONVERSION */
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+    struct sts3x_stats stats;                   /* see sts3x_get_stats_dev() */
+    sts3x_clock_usec_fn clock;                  /* NULL to skip latencies */
+    sts3x_transaction_hook_fn transaction_hook; /* NULL if not used */
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+};
+
+/**
+ * Bus handle for sensors behind an I2C multiplexer (e.g. TCA9548A), to be used
+ * with sts3x_select_i2c_mux_channel() as select_bus function.
+ */
+struct sts3x_i2c_mux_channel {
+    uint8_t mux_address; /* I2C address of the multiplexer */
+    uint8_t channel;     /* multiplexer channel, 0..7 */
+};
+
+/**
+ * Alert limits in milli degree Celsius, see sts3x_set_alert_limits().
+ *
+ * The ALERT pin is activated when the temperature rises above high_set and
+ * deactivated when it falls below high_clear again, and likewise for low
+ * temperatures with low_set and low_clear. The sensor stores the limits with a
+ * resolution of about 0.34 degree Celsius.
+ */
+struct sts3x_alert_limits {
+    int32_t high_set;
+    int32_t high_clear;
+    int32_t low_clear;
+    int32_t low_set;
+};
+
+/**
+ * Decoded status register, see sts3x_decode_status(). Each flag is 1 if set.
+ */
+struct sts3x_status {
+    uint8_t alert_pending;     /* at least one alert is pending */
+    uint8_t heater_on;         /* the heater is enabled */
+    uint8_t temperature_alert; /* the temperature is outside the alert limits */
+    uint8_t reset_detected;    /* reset since the status was last cleared */
+    uint8_t command_failed;    /* the last command was not processed */
+    uint8_t write_crc_failed;  /* the checksum of the last write was wrong */
+};
+
+#ifndef STS3X_DISABLE_DISCOVERY
+#ifndef STS3X_DISCOVERY_MAX_SENSORS
+#define STS3X_DISCOVERY_MAX_SENSORS 16
+#endif /* STS3X_DISCOVERY_MAX_SENSORS */
+#define STS3X_DISCOVERY_NO_MUX 0xFF
+
+/**
+ * Sensor found by sts3x_discover().
+ */
+struct sts3x_discovered_sensor {
+    uint32_t serial;     /* serial number, see sts3x_read_serial() */
+    uint8_t address;     /* I2C address of the sensor */
+    uint8_t mux_address; /* STS3X_DISCOVERY_NO_MUX if directly attached */
+    uint8_t mux_channel; /* multiplexer channel, 0..7 */
+};
+
+/**
+ * Sensors found by sts3x_discover(). The table is self-contained (no pointers)
+ * and protected by a CRC, so it can be kept across warm restarts, e.g. in
+ * retained RAM or flash, see sts3x_discover_cached().
+ */
+struct sts3x_discovery_table {
+    uint16_t count; /* number of valid entries in sensors */
+    uint8_t crc;    /* see sts3x_discovery_table_is_valid() */
+    struct sts3x_discovered_sensor sensors[STS3X_DISCOVERY_MAX_SENSORS];
+};
+#endif /* STS3X_DISABLE_DISCOVERY */
+
+#ifndef STS3X_DISABLE_HEATER
+/**
+ * Parameters of the heater self-test, see sts3x_self_test_init().
+ */
+struct sts3x_self_test_config {
+    int32_t min_increase;         /* milli degree Celsius to pass the test */
+    uint32_t check_interval_usec; /* heating time between measurements */
+    uint32_t budget_usec;         /* upper bound of the test duration */
+};
+
+/* passes with 0.5 degree Celsius within 2 seconds, checked every 100ms */
+#define STS3X_SELF_TEST_CONFIG_DEFAULT \
+    { 500, 100000, 2000000 }
+
+/**
+ * Heater self-test of a sensor, see sts3x_self_test_init().
+ */
+struct sts3x_self_test {
+    struct sts3x_dev* dev;
+    const struct sts3x_self_test_config* config;
+    int16_t result;         /* STATUS_IN_PROGRESS until the test is done */
+    int32_t baseline;       /* temperature before heating */
+    int32_t increase;       /* increase at the last heated measurement */
+    uint32_t duration_usec; /* duration of the test once done */
+    /* internal state, see sts3x_self_test_poll() */
+    uint8_t state;
+    uint8_t heater_off_attempts;
+    int16_t outcome; /* result once the heater is off again */
+    uint32_t started_at_usec;
+    uint32_t due_at_usec;
+};
+#endif /* STS3X_DISABLE_HEATER */
+
 /**
  * Detects if a sensor is connected by reading out the ID register.
  * If the sensor does not answer or if the answer is not the expected value,
- * the test fails.
+ * the test fails. The status register read out is cached, see
+ * sts3x_get_cached_status().
  *
  * @return 0 if a sensor was detected
  */
@@ -78,9 +397,45 @@ int16_t sts3x_probe(void);
 int16_t sts3x_measure_blocking_read(int32_t* temperature);
 
 /**
- * Starts a measurement in high precision mode. Use sts3x_read() to read out the
- * values, once the measurement is done. The duration of the measurement depends
- * on the sensor in use, please consult the datasheet.
+ * Starts a measurement and then polls for the result. Unlike
+ * sts3x_measure_blocking_read() this function only waits for the typical
+ * measurement duration of the configured repeatability and then retries the
+ * read out until the sensor acknowledges it, bounded by the worst case duration
+ * returned by sts3x_get_measurement_duration_usec().
+ * Temperature is returned in [degree Celsius], multiplied by 1000
+ *
+ * @param temperature   the address for the result of the temperature
+ * measurement
+ * @return              0 if the command was successful, else an error code.
+ */
+int16_t sts3x_measure_polling_read(int32_t* temperature);
+
+/**
+ * Non-blocking measurement. The first call starts a measurement and returns
+ * STATUS_IN_PROGRESS together with the time at which the result will be
+ * ready. Further calls return STATUS_IN_PROGRESS until that time is reached
+ * and then read out the result. The call after that starts the next
+ * measurement. This allows a scheduler to serve other tasks or sensors until
+ * ready_at_usec instead of sleeping.
+ * Temperature is returned in [degree Celsius], multiplied by 1000
+ *
+ * @param clock         monotonic clock in microseconds
+ * @param temperature   the address for the result of the temperature
+ *                      measurement, only written when 0 is returned
+ * @param ready_at_usec the address for the time at which the result is ready
+ *                      (in clock() time), only written when
+ *                      STATUS_IN_PROGRESS is returned
+ * @return              STATUS_IN_PROGRESS while the measurement is running,
+ *                      0 if the result was read out, else an error code.
+ */
+int16_t sts3x_measure_poll(sts3x_clock_usec_fn clock, int32_t* temperature,
+                           uint32_t* ready_at_usec);
+
+/**
+ * Starts a measurement with the configured repeatability (high repeatability by
+ * default). Use sts3x_read() to read out the values, once the measurement is
+ * done. The duration of the measurement is returned by
+ * sts3x_get_measurement_duration_usec().
  *
  * @return     0 if the command was successful, else an error code.
  */
@@ -98,6 +453,139 @@ int16_t sts3x_measure(void);
  */
 int16_t sts3x_read(int32_t* temperature);
 
+/**
+ * Same as sts3x_read() but returns the raw temperature signal S_T of the sensor
+ * instead of converting it, e.g. to store or convert many samples at once.
+ * Use sts3x_ticks_to_milli_celsius() or the bulk conversions in
+ * sensirion_temperature_unit_conversion.h to convert it.
+ * Temperature = 175 * S_T / 2^16 - 45
+ *
+ * @param ticks     the address for the raw temperature signal
+ * @return          0 if the command was successful, else an error code.
+ */
+int16_t sts3x_read_ticks(uint16_t* ticks);
+
+/**
+ * Returns the worst case duration of a measurement with the configured
+ * repeatability, i.e. the time to wait between sts3x_measure() and
+ * sts3x_read().
+ *
+ * @return     measurement duration in microseconds
+ */
+uint32_t sts3x_get_measurement_duration_usec(void);
+
+/**
+ * Returns the worst case duration of a measurement with the given
+ * repeatability, e.g. to plan measurements with different repeatabilities
+ * without changing the repeatability of a sensor.
+ *
+ * @param repeatability 0 for high, 1 for medium, 2 for low repeatability, see
+ *                      sts3x_set_repeatability()
+ * @return              measurement duration in microseconds
+ */
+uint32_t sts3x_get_measurement_duration_usec_for(uint8_t repeatability);
+
+#ifndef STS3X_DISABLE_PERIODIC
+/**
+ * Starts the periodic measurement mode. The sensor then measures on its own at
+ * the given rate, using the repeatability configured with
+ * sts3x_set_repeatability(). Use sts3x_fetch_data() to read out the latest
+ * measurement and sts3x_stop_periodic_measurement() to return to single shot
+ * mode. sts3x_measure() must not be used while the periodic mode is active.
+ *
+ * With STS3X_MEASUREMENT_RATE_ART, the sensor measures 4 times per second
+ * with accelerated response time (ART) to follow fast temperature changes.
+ *
+ * @param rate  measurements per second, one of STS3X_MEASUREMENT_RATE_0_5_MPS,
+ *              STS3X_MEASUREMENT_RATE_1_MPS, STS3X_MEASUREMENT_RATE_2_MPS,
+ *              STS3X_MEASUREMENT_RATE_4_MPS, STS3X_MEASUREMENT_RATE_10_MPS or
+ *              STS3X_MEASUREMENT_RATE_ART
+ * @return      0 if the command was successful, else an error code.
+ */
+int16_t sts3x_start_periodic_measurement(uint8_t rate);
+
+/**
+ * Reads out the latest measurement of the periodic measurement mode started
+ * with sts3x_start_periodic_measurement(). If no new measurement is available
+ * since the last fetch, the sensor does not acknowledge the read and this
+ * function returns an error.
+ * Temperature is returned in [degree Celsius], multiplied by 1000
+ *
+ * @param temperature   the address for the result of the temperature
+ * measurement
+ * @return              0 if the command was successful, else an error code.
+ */
+int16_t sts3x_fetch_data(int32_t* temperature);
+
+/**
+ * Same as sts3x_fetch_data() but returns the raw temperature signal S_T of the
+ * sensor instead of converting it.
+ *
+ * @param ticks     the address for the raw temperature signal
+ * @return          0 if the command was successful, else an error code.
+ */
+int16_t sts3x_fetch_ticks(uint16_t* ticks);
+
+/**
+ * Waits for the next measurement of the periodic measurement mode and reads it
+ * out. It sleeps until shortly before the measurement is due and then polls
+ * the sensor, so calling this function in a loop follows the clock of the
+ * sensor and yields each measurement once. Returns an error if there is no new
+ * measurement one interval after it was due.
+ * Temperature is returned in [degree Celsius], multiplied by 1000
+ *
+ * @param temperature   the address for the result of the temperature
+ * measurement
+ * @return              0 if the command was successful, else an error code.
+ */
+int16_t sts3x_periodic_blocking_read(int32_t* temperature);
+
+/**
+ * Non-blocking read out of the periodic measurement mode which follows the
+ * measurement interval of the sensor instead of sleeping. Each measurement is
+ * read out once, together with the time the sensor completed it. Call it right
+ * after sts3x_start_periodic_measurement() and then again at the returned
+ * ready time, e.g. from a timer or an event loop, to drain every measurement
+ * at the rate set by the sensor:
+ *
+ *   ret = sts3x_fetch_timestamped(clock, &temperature, &timestamp, &ready_at);
+ *   if (ret == STATUS_IN_PROGRESS)
+ *       wake up at ready_at and call it again
+ *
+ * The first measurement is found by polling the sensor every millisecond,
+ * later ones are read out once they are due according to the measurement
+ * interval and polled for if the sensor is late. Timestamps of consecutive
+ * measurements are one interval apart; if read outs are late by more than one
+ * interval, the missed measurements are skipped and the timestamp is that of
+ * the latest one. If the sensor does not acknowledge the fetch command, or has
+ * no measurement two intervals after one was due (e.g. because it was reset),
+ * an error is returned. Restart the periodic measurement in that case.
+ * Temperature is returned in [degree Celsius], multiplied by 1000
+ *
+ * @param clock             monotonic clock in microseconds
+ * @param temperature       the address for the result of the temperature
+ *                          measurement
+ * @param timestamp_usec    the address for the time of the measurement
+ * @param ready_at_usec     the address for the time at which the next
+ *                          measurement is expected, set if STATUS_IN_PROGRESS
+ *                          is returned
+ * @return                  0 if a measurement was read out, STATUS_IN_PROGRESS
+ *                          if no new measurement is available yet, else an
+ *                          error code.
+ */
+int16_t sts3x_fetch_timestamped(sts3x_clock_usec_fn clock, int32_t* temperature,
+                                uint32_t* timestamp_usec,
+                                uint32_t* ready_at_usec);
+
+/**
+ * Stops the periodic measurement mode (break command) and returns the sensor to
+ * single shot mode.
+ *
+ * @return     0 if the command was successful, else an error code.
+ */
+int16_t sts3x_stop_periodic_measurement(void);
+#endif /* STS3X_DISABLE_PERIODIC */
+
 /**
  * Set repeatability of the STS
  *
@@ -107,6 +595,7 @@ int16_t sts3x_read(int32_t* temperature);
  */
 void sts3x_set_repeatability(uint8_t repeatability);
 
+#ifndef STS3X_DISABLE_HEATER
 /**
  * Enable internal heater. The heater is meant for plausibility check only.
  *
@@ -123,6 +612,66 @@ int16_t sts3x_heater_on(void);
  */
 int16_t sts3x_heater_off(void);
 
+/**
+ * Prepares a heater self-test (plausibility check) of a sensor in single shot
+ * mode, to be run with sts3x_self_test_poll() or sts3x_self_test_run().
+ *
+ * The test measures the temperature, turns the heater on and measures again
+ * every check_interval_usec until the temperature rose by min_increase. It
+ * fails with STATUS_SELF_TEST_FAILED if that is not reached within
+ * budget_usec. The budget is only exceeded by the time the bus is busy with
+ * the other sensors tested at the same time. The heater is turned off again
+ * in any case, also if the sensor fails during the test.
+ *
+ * @param test      the test to initialize
+ * @param dev       the sensor, must stay valid during the test
+ * @param config    the test parameters, e.g. STS3X_SELF_TEST_CONFIG_DEFAULT,
+ *                  must stay valid during the test
+ */
+void sts3x_self_test_init(struct sts3x_self_test* test, struct sts3x_dev* dev,
+                          const struct sts3x_self_test_config* config);
+
+/**
+ * Advances the self-tests of many sensors without blocking. All tests run at
+ * the same time, so the heater of each sensor is on for about the same time as
+ * if it was tested alone. Call it again at next_due_usec or later until it
+ * returns something else than STATUS_IN_PROGRESS.
+ *
+ * The result of each test is in its result field: 0 if the temperature rose
+ * as expected, STATUS_SELF_TEST_FAILED if it did not, STATUS_ERR_BAD_DATA if
+ * the sensor is in periodic mode, else the error code of the bus. If the
+ * heater could not be turned off after an error, the heater flag of the cached
+ * status stays set, see sts3x_get_cached_status_dev().
+ *
+ * @param tests         array of num_tests tests, see sts3x_self_test_init()
+ * @param num_tests     the number of tests
+ * @param clock         monotonic clock in microseconds
+ * @param next_due_usec the address for the time at which the next step of the
+ *                      tests is due, only written when STATUS_IN_PROGRESS is
+ *                      returned
+ * @return              STATUS_IN_PROGRESS while tests are running, else 0 if
+ *                      all tests passed or the result of the first failed
+ *                      test
+ */
+int16_t sts3x_self_test_poll(struct sts3x_self_test* tests, uint16_t num_tests,
+                             sts3x_clock_usec_fn clock,
+                             uint32_t* next_due_usec);
+
+/**
+ * Runs the self-tests of many sensors at the same time and sleeps until all
+ * of them are done, see sts3x_self_test_poll().
+ *
+ * @param tests         array of num_tests tests, see sts3x_self_test_init()
+ * @param num_tests     the number of tests
+ * @param clock         monotonic clock in microseconds
+ * @return              0 if all tests passed, else the result of the first
+ *                      failed test
+ */
+int16_t sts3x_self_test_run(struct sts3x_self_test* tests, uint16_t num_tests,
+                            sts3x_clock_usec_fn clock);
+#endif /* STS3X_DISABLE_HEATER */
+
+#ifndef STS3X_DISABLE_SERIAL
 /**
  * Read out the serial number
  *
@@ -130,6 +679,83 @@ int16_t sts3x_heater_off(void);
  * @return          0 if the command was successful, else an error code.
  */
 int16_t sts3x_read_serial(uint32_t* serial);
+#endif /* STS3X_DISABLE_SERIAL */
+
+/**
+ * Reads out the status register. The value is cached, see
+ * sts3x_get_cached_status(). Use sts3x_decode_status() or the
+ * STS3X_STATUS_* masks to interpret it.
+ *
+ * @param status    the address for the status register
+ * @return          0 if the command was successful, else an error code.
+ */
+int16_t sts3x_read_status(uint16_t* status);
+
+/**
+ * Clears the alert, reset, command and write checksum flags of the status
+ * register.
+ *
+ * Clear the status once after start up, then the STS3X_STATUS_RESET_DETECTED
+ * flag tells if the sensor was reset in between, e.g. by a brown out, and lost
+ * its configuration (periodic mode, heater, alert limits).
+ *
+ * @return          0 if the command was successful, else an error code.
+ */
+int16_t sts3x_clear_status(void);
+
+/**
+ * Returns the status register as last read by sts3x_read_status() or
+ * sts3x_probe(), updated by the driver for its own commands (e.g. heater on or
+ * off, clear status) without accessing the bus.
+ *
+ * @param status    the address for the status register
+ * @return          0 if a cached value is available, STATUS_ERR_BAD_DATA if
+ *                  the status was never read.
+ */
+int16_t sts3x_get_cached_status(uint16_t* status);
+
+/**
+ * Decodes a status register value.
+ *
+ * @param status    the status register value
+ * @param decoded   the address for the decoded flags
+ */
+void sts3x_decode_status(uint16_t status, struct sts3x_status* decoded);
+
+#ifndef STS3X_DISABLE_ALERT
+/**
+ * Writes the alert limits to the sensor. The limits are lost when the sensor
+ * is reset.
+ *
+ * @param limits    the alert limits, low_set <= low_clear < high_clear <=
+ *                  high_set
+ * @return          0 if the command was successful, STATUS_ERR_BAD_DATA if
+ *                  the limits are not in order, else an error code.
+ */
+int16_t sts3x_set_alert_limits(const struct sts3x_alert_limits* limits);
+
+/**
+ * Reads the alert limits from the sensor.
+ *
+ * @param limits    the address for the alert limits
+ * @return          0 if the command was successful, else an error code.
+ */
+int16_t sts3x_get_alert_limits(struct sts3x_alert_limits* limits);
+
+/**
+ * Configures the alert limits, clears pending alerts and starts the periodic
+ * measurement. The sensor then compares each measurement with the limits and
+ * drives its ALERT pin, so the host can sleep until the pin fires instead of
+ * polling. Afterwards, sts3x_read_status() tells which alert is pending and
+ * sts3x_fetch_data() returns the latest temperature.
+ *
+ * @param rate      the measurement rate, one of STS3X_MEASUREMENT_RATE_*
+ * @param limits    the alert limits, see sts3x_set_alert_limits()
+ * @return          0 if the command was successful, else an error code.
+ */
+int16_t sts3x_start_alert_mode(uint8_t rate,
+                               const struct sts3x_alert_limits* limits);
+#endif /* STS3X_DISABLE_ALERT */
 
 /**
  * Return the driver version
@@ -145,6 +771,340 @@ const char* sts3x_get_driver_version(void);
  */
 uint8_t sts3x_get_configured_address(void);
 
+/**
+ * Initializes a sensor instance with default settings: high repeatability,
+ * single shot mode and no bus selection.
+ *
+ * @param dev       the sensor instance to initialize
+ * @param address   the I2C address of the sensor, STS3X_ADDRESS_DEFAULT or
+ *                  STS3X_ADDRESS_ALTERNATE
+ */
+void sts3x_init_dev(struct sts3x_dev* dev, uint8_t address);
+
+/**
+ * Bus selection function for sensors behind an I2C multiplexer. Enables only
+ * the channel described by mux_channel.
+ *
+ * @param mux_channel   pointer to a struct sts3x_i2c_mux_channel
+ * @return              0 if the command was successful, else an error code.
+ */
+int16_t sts3x_select_i2c_mux_channel(void* mux_channel);
+
+#ifndef STS3X_DISABLE_DISCOVERY
+/**
+ * Finds all sensors on the bus and behind the given I2C multiplexers, e.g. at
+ * boot instead of probing each possible sensor with sts3x_probe_dev().
+ *
+ * Both sensor addresses are checked on the bus itself and on every channel of
+ * each multiplexer with an address only transaction, which costs about 0.1ms
+ * at 100kHz and needs no command wait. The serial number is then read from all
+ * responding sensors at once: the commands are sent back to back and the
+ * responses are read out after a single command wait. Sensors directly on the
+ * bus appear on every multiplexer channel and are only reported once.
+ *
+ * All multiplexer channels are disabled afterwards. Do not use the sensors from
+ * other threads during the discovery.
+ *
+ * @param mux_addresses array of num_muxes multiplexer addresses, may be NULL
+ *                      if num_muxes is 0
+ * @param num_muxes     the number of multiplexers
+ * @param table         the address for the found sensors, ordered by
+ *                      multiplexer, channel and address
+ * @return              0 on success, STATUS_NACK if a multiplexer did not
+ *                      acknowledge (the table holds the sensors found on the
+ *                      bus and behind the other multiplexers),
+ *                      STATUS_ERR_BAD_DATA if more sensors were found than fit
+ *                      into the table (the table holds the first
+ *                      STS3X_DISCOVERY_MAX_SENSORS)
+ */
+int16_t sts3x_discover(const uint8_t* mux_addresses, uint8_t num_muxes,
+                       struct sts3x_discovery_table* table);
+
+/**
+ * Checks the CRC of a discovery table, e.g. after a restart.
+ *
+ * @param table     the table
+ * @return          1 if the table is intact, else 0
+ */
+uint8_t
+sts3x_discovery_table_is_valid(const struct sts3x_discovery_table* table);
+
+/**
+ * Checks with an address only transaction that all sensors of a discovery
+ * table still respond at their place. Sensors which were swapped for other
+ * ones at the same place are not detected, compare the serial numbers to catch
+ * these.
+ *
+ * @param table     the table
+ * @return          0 if all sensors responded, else STATUS_NACK
+ */
+int16_t sts3x_discovery_verify(const struct sts3x_discovery_table* table);
+
+/**
+ * Uses a discovery table from a previous run if it is intact and all of its
+ * sensors still respond, else runs sts3x_discover() to fill it anew. A warm
+ * restart thus costs one address only transaction per sensor instead of a full
+ * scan.
+ *
+ * @param mux_addresses see sts3x_discover()
+ * @param num_muxes     see sts3x_discover()
+ * @param table         the table of the previous run, possibly uninitialized
+ * @param rescanned     the address for the result: 1 if the table was filled
+ *                      anew and should be stored, 0 if it was kept
+ * @return              0 on success, else the error code of sts3x_discover()
+ */
+int16_t sts3x_discover_cached(const uint8_t* mux_addresses, uint8_t num_muxes,
+                              struct sts3x_discovery_table* table,
+                              uint8_t* rescanned);
+
+/**
+ * Initializes a sensor instance for an entry of a discovery table.
+ *
+ * @param dev           the sensor instance to initialize
+ * @param mux_channel   the bus handle for sensors behind a multiplexer, must
+ *                      stay valid while dev is in use
+ * @param sensor        the table entry
+ */
+void sts3x_init_discovered_dev(struct sts3x_dev* dev,
+                               struct sts3x_i2c_mux_channel* mux_channel,
+                               const struct sts3x_discovered_sensor* sensor);
+#endif /* STS3X_DISABLE_DISCOVERY */
+
+/**
+ * Measures all given sensors at once. The measurements are started back to back
+ * on all sensors, then this function waits once for the longest measurement
+ * duration and reads out all results. A sweep over N sensors thus takes about
+ * one measurement duration instead of N.
+ * Temperatures are returned in [degree Celsius], multiplied by 1000
+ *
+ * @param devs          array of num_devs sensor instances
+ * @param num_devs      number of sensors
+ * @param temperatures  array of num_devs results, only valid where the
+ *                      corresponding status is 0
+ * @param status        array of num_devs status codes, 0 if the measurement of
+ *                      the sensor was successful, else an error code.
+ * @return              0 if all measurements were successful, else the error
+ *                      code of the first failing sensor.
+ */
+int16_t sts3x_measure_blocking_read_batch(struct sts3x_dev* devs,
+                                          uint16_t num_devs,
+                                          int32_t* temperatures,
+                                          int16_t* status);
+
+/**
+ * Converts a raw temperature signal as returned by sts3x_read_ticks() to
+ * [degree Celsius], multiplied by 1000
+ *
+ * @param ticks     the raw temperature signal S_T
+ * @return          the temperature in milli degree Celsius
+ */
+int32_t sts3x_ticks_to_milli_celsius(uint16_t ticks);
+
+/*
+ * The following functions are equivalent to the functions without the _dev
+ * suffix, but operate on the sensor instance dev.
+ */
+
+int16_t sts3x_probe_dev(struct sts3x_dev* dev);
+
+int16_t sts3x_measure_blocking_read_dev(struct sts3x_dev* dev,
+                                        int32_t* temperature);
+
+int16_t sts3x_measure_polling_read_dev(struct sts3x_dev* dev,
+                                       int32_t* temperature);
+
+int16_t sts3x_measure_poll_dev(struct sts3x_dev* dev,
+                               sts3x_clock_usec_fn clock, int32_t* temperature,
+                               uint32_t* ready_at_usec);
+
+int16_t sts3x_measure_dev(struct sts3x_dev* dev);
+
+int16_t sts3x_read_dev(struct sts3x_dev* dev, int32_t* temperature);
+
+int16_t sts3x_read_ticks_dev(struct sts3x_dev* dev, uint16_t* ticks);
+
+uint32_t sts3x_get_measurement_duration_usec_dev(const struct sts3x_dev* dev);
+
+#ifndef STS3X_DISABLE_PERIODIC
+int16_t sts3x_start_periodic_measurement_dev(struct sts3x_dev* dev,
+                                             uint8_t rate);
+
+int16_t sts3x_fetch_data_dev(struct sts3x_dev* dev, int32_t* temperature);
+
+int16_t sts3x_fetch_ticks_dev(struct sts3x_dev* dev, uint16_t* ticks);
+
+int16_t sts3x_periodic_blocking_read_dev(struct sts3x_dev* dev,
+                                         int32_t* temperature);
+
+int16_t sts3x_fetch_timestamped_dev(struct sts3x_dev* dev,
+                                    sts3x_clock_usec_fn clock,
+                                    int32_t* temperature,
+                                    uint32_t* timestamp_usec,
+                                    uint32_t* ready_at_usec);
+
+int16_t sts3x_stop_periodic_measurement_dev(struct sts3x_dev* dev);
+#endif /* STS3X_DISABLE_PERIODIC */
+
+void sts3x_set_repeatability_dev(struct sts3x_dev* dev, uint8_t repeatability);
+
+#ifndef STS3X_DISABLE_HEATER
+int16_t sts3x_heater_on_dev(struct sts3x_dev* dev);
+
+int16_t sts3x_heater_off_dev(struct sts3x_dev* dev);
+#endif /* STS3X_DISABLE_HEATER */
+
+#ifndef STS3X_DISABLE_SERIAL
+int16_t sts3x_read_serial_dev(struct sts3x_dev* dev, uint32_t* serial);
+#endif /* STS3X_DISABLE_SERIAL */
+
+int16_t sts3x_read_status_dev(struct sts3x_dev* dev, uint16_t* status);
+
+int16_t sts3x_clear_status_dev(struct sts3x_dev* dev);
+
+int16_t sts3x_get_cached_status_dev(const struct sts3x_dev* dev,
+                                    uint16_t* status);
+
+#ifndef STS3X_DISABLE_ALERT
+int16_t sts3x_set_alert_limits_dev(struct sts3x_dev* dev,
+                                   const struct sts3x_alert_limits* limits);
+
+int16_t sts3x_get_alert_limits_dev(struct sts3x_dev* dev,
+                                   struct sts3x_alert_limits* limits);
+
+int16_t sts3x_start_alert_mode_dev(struct sts3x_dev* dev, uint8_t rate,
+                                   const struct sts3x_alert_limits* limits);
+
+/**
+ * Writes or reads a single alert limit.
+ *
+ * @param dev           the sensor instance
+ * @param limit         one of STS3X_ALERT_LIMIT_*
+ * @param temperature   the limit in milli degree Celsius
+ * @return              0 if the command was successful, else an error code.
+ */
+int16_t sts3x_set_alert_limit_dev(struct sts3x_dev* dev, uint8_t limit,
+                                  int32_t temperature);
+
+int16_t sts3x_get_alert_limit_dev(struct sts3x_dev* dev, uint8_t limit,
+                                  int32_t* temperature);
+#endif /* STS3X_DISABLE_ALERT */
+
+#ifndef STS3X_DISABLE_RETRY
+/**
+ * Sets how a sensor instance handles transient I2C failures. Without a retry
+ * policy, the default, failures are returned to the caller right away.
+ *
+ * @param dev       the sensor instance
+ * @param policy    the retry policy, must stay valid while it is in use. NULL
+ *                  to disable retries.
+ */
+void sts3x_set_retry_policy_dev(struct sts3x_dev* dev,
+                                const struct sts3x_retry_policy* policy);
+
+/**
+ * Sets the retry policy of the default instance, see
+ * sts3x_set_retry_policy_dev().
+ *
+ * @param policy    the retry policy, NULL to disable retries
+ */
+void sts3x_set_retry_policy(const struct sts3x_retry_policy* policy);
+#endif /* STS3X_DISABLE_RETRY */
+
+/**
+ * Sets the lock of the bus a sensor is attached to, for hosts where several
+ * threads use the driver. Without a lock, the default, a sensor instance and
+ * its bus must only be used by one thread at a time.
+ *
+ * With a lock, every function holds it across its complete command sequence,
+ * e.g. sts3x_measure_blocking_read_dev() from starting the measurement until
+ * the result is read out. sts3x_measure_blocking_read_batch() holds the locks
+ * of all buses of the batch. Sequences which span several calls, i.e.
+ * sts3x_measure_dev() followed by sts3x_read_dev() and
+ * sts3x_measure_poll_dev(), release the lock in between and therefore require
+ * that no other thread accesses the same sensor meanwhile.
+ *
+ * @param dev   the sensor instance
+ * @param lock  the bus lock, must stay valid while it is in use. NULL to not
+ *              lock.
+ */
+void sts3x_set_bus_lock_dev(struct sts3x_dev* dev,
+                            const struct sts3x_bus_lock* lock);
+
+/**
+ * Sets the bus lock of the default instance, see sts3x_set_bus_lock_dev().
+ *
+ * @param lock  the bus lock, NULL to not lock
+ */
+void sts3x_set_bus_lock(const struct sts3x_bus_lock* lock);
+
+#ifndef STS3X_DISABLE_CONVERSION
+/**
+ * Sets how the raw temperature signals of a sensor are converted by all
+ * functions which return temperatures, e.g. sts3x_read_dev() and
+ * sts3x_fetch_timestamped_dev(). Functions which return raw signals are not
+ * affected. Without a conversion, the default, the standard formula of
+ * sts3x_ticks_to_milli_celsius() is used.
+ *
+ * To apply per sensor calibration coefficients, look up the entry of the
+ * sensor by its serial number (see sts3x_read_serial_dev()) with
+ * sensirion_temperature_calibration_find() and set it together with
+ * sensirion_ticks_to_celsius_calibrated() (utils).
+ *
+ * @param dev           the sensor instance
+ * @param convert       the conversion, NULL for the standard formula
+ * @param calibration   passed to convert, must stay valid while it is in use
+ */
+void sts3x_set_conversion_dev(struct sts3x_dev* dev, sts3x_convert_fn convert,
+                              const void* calibration);
+
+/**
+ * Sets the conversion of the default instance, see sts3x_set_conversion_dev().
+ *
+ * @param convert       the conversion, NULL for the standard formula
+ * @param calibration   passed to convert
+ */
+void sts3x_set_conversion(sts3x_convert_fn convert, const void* calibration);
+#endif /* STS3X_DISABLE_CONVERSION */
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+/**
+ * Sets the clock used to measure the latency of the transactions with a sensor
+ * and a hook called after each transaction. Only available if the driver is
+ * compiled with STS3X_ENABLE_INSTRUMENTATION, without it the instrumentation
+ * does not add any code or data.
+ *
+ * @param dev   the sensor instance
+ * @param clock the clock for the latencies, NULL to not record latencies
+ * @param hook  the transaction hook, NULL to disable it
+ */
+void sts3x_set_instrumentation_dev(struct sts3x_dev* dev,
+                                   sts3x_clock_usec_fn clock,
+                                   sts3x_transaction_hook_fn hook);
+
+/**
+ * Copies the bus statistics of a sensor.
+ *
+ * @param dev   the sensor instance
+ * @param stats the address for the statistics
+ */
+void sts3x_get_stats_dev(const struct sts3x_dev* dev,
+                         struct sts3x_stats* stats);
+
+/**
+ * Resets the bus statistics of a sensor.
+ *
+ * @param dev   the sensor instance
+ */
+void sts3x_reset_stats_dev(struct sts3x_dev* dev);
+
+void sts3x_set_instrumentation(sts3x_clock_usec_fn clock,
+                               sts3x_transaction_hook_fn hook);
+
+void sts3x_get_stats(struct sts3x_stats* stats);
+
+void sts3x_reset_stats(void);
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Compact binary format for batches of STS3x samples, implementation
+ */
+
+#include "sts3x_batch.h"
+#include "sensirion_arch_config.h"
+#include "sts3x.h"
+
+static const uint8_t STS3X_BATCH_MAGIC[] = {'S', 'T', 'S', 'B'};
+
+/* CRC-16/CCITT-FALSE, processed 4 bits at a time to keep the table small */
+static const uint16_t STS3X_BATCH_CRC_TABLE[] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+#define STS3X_BATCH_CRC_INIT 0xFFFF
+
+static uint16_t sts3x_batch_crc(const uint8_t* data, size_t length) {
+    uint16_t crc = STS3X_BATCH_CRC_INIT;
+    size_t i;
+
+    for (i = 0; i < length; ++i) {
+        crc = (uint16_t)(crc << 4) ^
+              STS3X_BATCH_CRC_TABLE[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (uint16_t)(crc << 4) ^
+              STS3X_BATCH_CRC_TABLE[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+static void sts3x_batch_put_uint16(uint8_t* buffer, uint16_t value) {
+    buffer[0] = (uint8_t)(value >> 8);
+    buffer[1] = (uint8_t)value;
+}
+
+static void sts3x_batch_put_uint32(uint8_t* buffer, uint32_t value) {
+    sts3x_batch_put_uint16(buffer, (uint16_t)(value >> 16));
+    sts3x_batch_put_uint16(&buffer[2], (uint16_t)value);
+}
+
+static uint16_t sts3x_batch_get_uint16(const uint8_t* data) {
+    return (uint16_t)((uint16_t)data[0] << 8 | data[1]);
+}
+
+static uint32_t sts3x_batch_get_uint32(const uint8_t* data) {
+    return (uint32_t)sts3x_batch_get_uint16(data) << 16 |
+           sts3x_batch_get_uint16(&data[2]);
+}
+
+/* returns the number of bytes written */
+static uint8_t sts3x_batch_put_varint(uint8_t* buffer, uint32_t value) {
+    uint8_t length = 0;
+
+    while (value >= 0x80) {
+        buffer[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = (uint8_t)value;
+    return length;
+}
+
+/* returns the number of bytes read, 0 if the varint is truncated or too long */
+static uint8_t sts3x_batch_get_varint(const uint8_t* data, size_t length,
+                                      uint32_t* value) {
+    uint32_t result = 0;
+    uint8_t i;
+
+    for (i = 0; i < 5 && i < length; ++i) {
+        result |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+        if (!(data[i] & 0x80)) {
+            *value = result;
+            return (uint8_t)(i + 1);
+        }
+    }
+    return 0;
+}
+
+int16_t sts3x_batch_encoder_init(struct sts3x_batch_encoder* encoder,
+                                 uint8_t* buffer, uint16_t size,
+                                 uint32_t serial, uint8_t repeatability,
+                                 uint32_t base_timestamp) {
+    uint8_t i;
+
+    if (size < STS3X_BATCH_HEADER_SIZE + STS3X_BATCH_CRC_SIZE)
+        return STATUS_ERR_BAD_DATA;
+
+    for (i = 0; i < sizeof(STS3X_BATCH_MAGIC); ++i)
+        buffer[i] = STS3X_BATCH_MAGIC[i];
+    buffer[4] = STS3X_BATCH_VERSION;
+    buffer[5] = repeatability;
+    sts3x_batch_put_uint16(&buffer[6], 0);
+    sts3x_batch_put_uint32(&buffer[8], serial);
+    sts3x_batch_put_uint32(&buffer[12], base_timestamp);
+    sts3x_batch_put_uint16(&buffer[16], 0);
+    sts3x_batch_put_uint16(&buffer[18], 0);
+
+    encoder->buffer = buffer;
+    encoder->size = size;
+    encoder->length = STS3X_BATCH_HEADER_SIZE;
+    encoder->count = 0;
+    encoder->previous_ticks = 0;
+    encoder->previous_timestamp = base_timestamp;
+    return STATUS_OK;
+}
+
+int16_t sts3x_batch_encoder_add(struct sts3x_batch_encoder* encoder,
+                                uint16_t ticks, uint32_t timestamp) {
+    uint8_t sample[STS3X_BATCH_MAX_SAMPLE_SIZE];
+    int32_t delta = (int32_t)ticks - (int32_t)encoder->previous_ticks;
+    /* zigzag: small positive and negative differences get small codes */
+    uint32_t zigzag = delta < 0 ? ((uint32_t)-delta << 1) - 1
+                                : (uint32_t)delta << 1;
+    uint8_t length;
+    uint8_t i;
+
+    /* signed difference to handle the wrap around of the timestamps */
+    if ((int32_t)(timestamp - encoder->previous_timestamp) < 0 ||
+        encoder->count == 0xFFFF)
+        return STATUS_ERR_BAD_DATA;
+
+    length = sts3x_batch_put_varint(sample, zigzag);
+    length += sts3x_batch_put_varint(
+        &sample[length], timestamp - encoder->previous_timestamp);
+    if (encoder->length + length + STS3X_BATCH_CRC_SIZE > encoder->size)
+        return STATUS_ERR_BAD_DATA;
+
+    for (i = 0; i < length; ++i)
+        encoder->buffer[encoder->length + i] = sample[i];
+    encoder->length += length;
+    encoder->count++;
+    encoder->previous_ticks = ticks;
+    encoder->previous_timestamp = timestamp;
+    return STATUS_OK;
+}
+
+uint16_t sts3x_batch_encoder_count(const struct sts3x_batch_encoder* encoder) {
+    return encoder->count;
+}
+
+uint16_t sts3x_batch_encoder_finish(struct sts3x_batch_encoder* encoder) {
+    uint8_t* buffer = encoder->buffer;
+
+    sts3x_batch_put_uint16(&buffer[6], encoder->count);
+    sts3x_batch_put_uint16(&buffer[16], (uint16_t)(encoder->length -
+                                                   STS3X_BATCH_HEADER_SIZE));
+    sts3x_batch_put_uint16(&buffer[encoder->length],
+                           sts3x_batch_crc(buffer, encoder->length));
+    return encoder->length + STS3X_BATCH_CRC_SIZE;
+}
+
+int16_t sts3x_batch_decoder_init(struct sts3x_batch_decoder* decoder,
+                                 const uint8_t* data, size_t length,
+                                 struct sts3x_batch_header* header,
+                                 size_t* batch_length) {
+    size_t data_length;
+    uint8_t i;
+
+    if (length < STS3X_BATCH_HEADER_SIZE + STS3X_BATCH_CRC_SIZE)
+        return STATUS_ERR_BAD_DATA;
+    for (i = 0; i < sizeof(STS3X_BATCH_MAGIC); ++i) {
+        if (data[i] != STS3X_BATCH_MAGIC[i])
+            return STATUS_ERR_BAD_DATA;
+    }
+    if (data[4] != STS3X_BATCH_VERSION)
+        return STATUS_ERR_BAD_DATA;
+
+    data_length = sts3x_batch_get_uint16(&data[16]);
+    if (length < STS3X_BATCH_HEADER_SIZE + data_length + STS3X_BATCH_CRC_SIZE)
+        return STATUS_ERR_BAD_DATA;
+    if (sts3x_batch_crc(data, STS3X_BATCH_HEADER_SIZE + data_length) !=
+        sts3x_batch_get_uint16(&data[STS3X_BATCH_HEADER_SIZE + data_length]))
+        return STATUS_CRC_FAIL;
+
+    header->version = data[4];
+    header->repeatability = data[5];
+    header->count = sts3x_batch_get_uint16(&data[6]);
+    header->serial = sts3x_batch_get_uint32(&data[8]);
+    header->base_timestamp = sts3x_batch_get_uint32(&data[12]);
+    *batch_length =
+        STS3X_BATCH_HEADER_SIZE + data_length + STS3X_BATCH_CRC_SIZE;
+
+    decoder->data = &data[STS3X_BATCH_HEADER_SIZE];
+    decoder->length = data_length;
+    decoder->position = 0;
+    decoder->remaining = header->count;
+    decoder->previous_ticks = 0;
+    decoder->previous_timestamp = header->base_timestamp;
+    return STATUS_OK;
+}
+
+uint16_t sts3x_batch_decode(struct sts3x_batch_decoder* decoder,
+                            uint16_t* ticks, uint32_t* timestamps,
+                            uint16_t max_samples) {
+    const uint8_t* data = decoder->data;
+    size_t position = decoder->position;
+    uint16_t previous_ticks = decoder->previous_ticks;
+    uint32_t previous_timestamp = decoder->previous_timestamp;
+    uint32_t zigzag;
+    uint32_t delta;
+    uint8_t length;
+    uint16_t count = 0;
+
+    if (max_samples > decoder->remaining)
+        max_samples = decoder->remaining;
+
+    while (count < max_samples) {
+        /* single byte differences are by far the most common case */
+        if (position + 2 <= decoder->length && !(data[position] & 0x80) &&
+            !(data[position + 1] & 0x80)) {
+            zigzag = data[position];
+            delta = data[position + 1];
+            position += 2;
+        } else {
+            length = sts3x_batch_get_varint(
+                &data[position], decoder->length - position, &zigzag);
+            if (!length)
+                break;
+            position += length;
+            length = sts3x_batch_get_varint(
+                &data[position], decoder->length - position, &delta);
+            if (!length)
+                break;
+            position += length;
+        }
+        /* wraps around like the encoder's difference of two 16 bit values */
+        previous_ticks = (uint16_t)(previous_ticks +
+                                    ((zigzag >> 1) ^ (0u - (zigzag & 1))));
+        previous_timestamp += delta;
+        ticks[count] = previous_ticks;
+        timestamps[count] = previous_timestamp;
+        count++;
+    }
+
+    if (count < max_samples)
+        decoder->remaining = 0; /* malformed, stop decoding */
+    else
+        decoder->remaining -= count;
+    decoder->position = position;
+    decoder->previous_ticks = previous_ticks;
+    decoder->previous_timestamp = previous_timestamp;
+    return count;
+}
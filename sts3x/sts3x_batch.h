@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Compact binary format for batches of STS3x samples
+ *
+ * A batch contains timestamped raw temperature signals of one sensor, to be
+ * sent off the device or archived instead of formatted text. The encoder runs
+ * on the device and appends samples to a caller provided buffer as they are
+ * measured. The decoder is meant for hosts and decodes concatenated batches,
+ * e.g. a file of archived batches, without copying or allocating memory.
+ *
+ * Layout of a batch, multi byte values in big endian:
+ *
+ *   offset  size  content
+ *   0       4     magic "STSB"
+ *   4       1     format version, STS3X_BATCH_VERSION
+ *   5       1     repeatability of the measurements, see
+ *                 sts3x_set_repeatability()
+ *   6       2     number of samples
+ *   8       4     serial number of the sensor, see sts3x_read_serial()
+ *   12      4     base timestamp, in a time unit chosen by the application
+ *   16      2     length of the sample data in bytes
+ *   18      2     reserved, 0
+ *   20      n     sample data
+ *   20 + n  2     CRC-16/CCITT-FALSE (polynomial 0x1021, initialization
+ *                 0xFFFF) of all preceding bytes of the batch
+ *
+ * Each sample is stored as the difference of its raw temperature signal to the
+ * previous sample (the first one to 0) as zigzag encoded varint, followed by
+ * the difference of its timestamp to the previous sample (the first one to the
+ * base timestamp) modulo 2^32 as unsigned varint, so timestamps may wrap
+ * around within a batch. Varints store 7 bits per byte, least significant
+ * group first, with the most significant bit set on all but the last byte.
+ * Slowly changing temperatures at a constant interval take 2 bytes per sample.
+ */
+
+#ifndef STS3X_BATCH_H
+#define STS3X_BATCH_H
+
+#include "sensirion_arch_config.h"
+#include "sts3x.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STS3X_BATCH_VERSION 1
+#define STS3X_BATCH_HEADER_SIZE 20
+#define STS3X_BATCH_CRC_SIZE 2
+/* largest encoded sample: 3 bytes signal difference, 5 bytes time difference */
+#define STS3X_BATCH_MAX_SAMPLE_SIZE 8
+
+/**
+ * Batch encoder, see sts3x_batch_encoder_init().
+ */
+struct sts3x_batch_encoder {
+    uint8_t* buffer;
+    uint16_t size;   /* size of buffer */
+    uint16_t length; /* bytes used, without the CRC */
+    uint16_t count;  /* number of samples */
+    uint16_t previous_ticks;
+    uint32_t previous_timestamp;
+};
+
+/**
+ * Batch properties, see sts3x_batch_decoder_init().
+ */
+struct sts3x_batch_header {
+    uint8_t version;
+    uint8_t repeatability;
+    uint16_t count; /* number of samples */
+    uint32_t serial;
+    uint32_t base_timestamp;
+};
+
+/**
+ * Batch decoder, see sts3x_batch_decoder_init().
+ */
+struct sts3x_batch_decoder {
+    const uint8_t* data; /* sample data of the batch */
+    size_t length;       /* length of the sample data */
+    size_t position;     /* offset of the next sample in data */
+    uint16_t remaining;  /* samples not decoded yet */
+    uint16_t previous_ticks;
+    uint32_t previous_timestamp;
+};
+
+/**
+ * Starts a new batch in a caller provided buffer.
+ *
+ * @param encoder           the encoder to initialize
+ * @param buffer            the buffer for the batch, must stay valid until
+ *                          sts3x_batch_encoder_finish() is called
+ * @param size              the size of buffer, at least
+ *                          STS3X_BATCH_HEADER_SIZE + STS3X_BATCH_CRC_SIZE
+ * @param serial            the serial number of the sensor
+ * @param repeatability     the repeatability of the measurements
+ * @param base_timestamp    the timestamp the sample timestamps are relative
+ *                          to, e.g. that of the first sample
+ * @return                  0 on success, STATUS_ERR_BAD_DATA if buffer is too
+ *                          small
+ */
+int16_t sts3x_batch_encoder_init(struct sts3x_batch_encoder* encoder,
+                                 uint8_t* buffer, uint16_t size,
+                                 uint32_t serial, uint8_t repeatability,
+                                 uint32_t base_timestamp);
+
+/**
+ * Appends a sample to the batch.
+ *
+ * @param encoder   the encoder
+ * @param ticks     the raw temperature signal S_T, e.g. from sts3x_read_ticks()
+ * @param timestamp the time of the measurement, not before the previous sample
+ *                  and the base timestamp. The timestamp may wrap around, a
+ *                  gap of 2^31 or more to the previous sample is ambiguous and
+ *                  taken as going backwards.
+ * @return          0 on success, STATUS_ERR_BAD_DATA if the sample does not
+ *                  fit into the buffer (the batch is full and needs to be
+ *                  finished) or the timestamp goes backwards. The batch is
+ *                  not changed on errors.
+ */
+int16_t sts3x_batch_encoder_add(struct sts3x_batch_encoder* encoder,
+                                uint16_t ticks, uint32_t timestamp);
+
+/**
+ * Returns the number of samples in the batch.
+ *
+ * @param encoder   the encoder
+ * @return          the number of samples added so far
+ */
+uint16_t sts3x_batch_encoder_count(const struct sts3x_batch_encoder* encoder);
+
+/**
+ * Completes the batch: updates the header and appends the CRC. No samples can
+ * be added afterwards.
+ *
+ * @param encoder   the encoder
+ * @return          the length of the batch in bytes, starting at the beginning
+ *                  of the buffer
+ */
+uint16_t sts3x_batch_encoder_finish(struct sts3x_batch_encoder* encoder);
+
+/**
+ * Checks a batch and prepares decoding its samples. data may contain further
+ * batches after this one, see batch_length.
+ *
+ * @param decoder       the decoder to initialize
+ * @param data          the batch
+ * @param length        the number of available bytes at data
+ * @param header        the address for the batch properties
+ * @param batch_length  the address for the length of the batch, i.e. the
+ *                      offset of the next batch in data
+ * @return              0 on success, STATUS_ERR_BAD_DATA if the batch is
+ *                      truncated or has an unknown magic or version,
+ *                      STATUS_CRC_FAIL if the CRC does not match
+ */
+int16_t sts3x_batch_decoder_init(struct sts3x_batch_decoder* decoder,
+                                 const uint8_t* data, size_t length,
+                                 struct sts3x_batch_header* header,
+                                 size_t* batch_length);
+
+/**
+ * Decodes the next samples of a batch. Use sensirion_ticks_to_celsius_bulk()
+ * (utils) or sts3x_ticks_to_milli_celsius() to convert the signals.
+ *
+ * @param decoder       the decoder
+ * @param ticks         the address for the raw temperature signals
+ * @param timestamps    the address for the timestamps
+ * @param max_samples   the number of elements of ticks and timestamps
+ * @return              the number of decoded samples, 0 once all samples of
+ *                      the batch were decoded. Decoding stops early if the
+ *                      sample data is malformed.
+ */
+uint16_t sts3x_batch_decode(struct sts3x_batch_decoder* decoder,
+                            uint16_t* ticks, uint32_t* timestamps,
+                            uint16_t max_samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STS3X_BATCH_H */
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion STS3x sample ring buffer implementation
+ */
+
+#include "sts3x_ring_buffer.h"
+#include "sensirion_arch_config.h"
+#include "sts3x.h"
+
+static const uint16_t STS3X_RING_BUFFER_MAX_DELTA = 0xFFFF;
+
+static uint16_t sts3x_ring_buffer_index(const struct sts3x_ring_buffer* buffer,
+                                        uint16_t offset) {
+    uint32_t index = (uint32_t)buffer->head + offset;
+
+    if (index >= buffer->capacity)
+        index -= buffer->capacity;
+    return (uint16_t)index;
+}
+
+static void sts3x_ring_buffer_drop_oldest(struct sts3x_ring_buffer* buffer) {
+    buffer->head = sts3x_ring_buffer_index(buffer, 1);
+    buffer->count--;
+    if (buffer->count)
+        buffer->oldest_timestamp +=
+            buffer->entries[buffer->head].timestamp_delta;
+}
+
+void sts3x_ring_buffer_init(struct sts3x_ring_buffer* buffer,
+                            struct sts3x_ring_buffer_entry* entries,
+                            uint16_t capacity) {
+    buffer->entries = entries;
+    buffer->capacity = capacity;
+    sts3x_ring_buffer_clear(buffer);
+}
+
+void sts3x_ring_buffer_clear(struct sts3x_ring_buffer* buffer) {
+    buffer->head = 0;
+    buffer->count = 0;
+    buffer->oldest_timestamp = 0;
+    buffer->newest_timestamp = 0;
+}
+
+void sts3x_ring_buffer_push(struct sts3x_ring_buffer* buffer, uint16_t ticks,
+                            uint32_t timestamp) {
+    struct sts3x_ring_buffer_entry* entry;
+    uint32_t delta = 0;
+
+    if (buffer->count == buffer->capacity)
+        sts3x_ring_buffer_drop_oldest(buffer);
+
+    if (buffer->count == 0) {
+        buffer->oldest_timestamp = timestamp;
+    } else if ((int32_t)(timestamp - buffer->newest_timestamp) > 0) {
+        /* signed difference to handle the wrap around of the timestamps */
+        delta = timestamp - buffer->newest_timestamp;
+        if (delta > STS3X_RING_BUFFER_MAX_DELTA)
+            delta = STS3X_RING_BUFFER_MAX_DELTA;
+    }
+
+    entry = &buffer->entries[sts3x_ring_buffer_index(buffer, buffer->count)];
+    entry->ticks = ticks;
+    entry->timestamp_delta = (uint16_t)delta;
+    buffer->count++;
+    /* keep the timestamps consistent with the stored deltas */
+    buffer->newest_timestamp =
+        buffer->count == 1 ? timestamp : buffer->newest_timestamp + delta;
+}
+
+int16_t sts3x_ring_buffer_record_dev(struct sts3x_ring_buffer* buffer,
+                                     struct sts3x_dev* dev,
+                                     uint32_t timestamp) {
+    uint16_t ticks;
+    int16_t ret;
+
+#ifndef STS3X_DISABLE_PERIODIC
+    if (dev->mode == STS3X_MODE_PERIODIC)
+        ret = sts3x_fetch_ticks_dev(dev, &ticks);
+    else
+#endif /* STS3X_DISABLE_PERIODIC */
+        ret = sts3x_read_ticks_dev(dev, &ticks);
+    if (ret)
+        return ret;
+
+    sts3x_ring_buffer_push(buffer, ticks, timestamp);
+    return STATUS_OK;
+}
+
+uint16_t sts3x_ring_buffer_count(const struct sts3x_ring_buffer* buffer) {
+    return buffer->count;
+}
+
+uint16_t sts3x_ring_buffer_read(const struct sts3x_ring_buffer* buffer,
+                                uint16_t offset, struct sts3x_sample* samples,
+                                uint16_t max_samples) {
+    struct sts3x_ring_buffer_cursor cursor;
+    uint16_t i;
+
+    if (offset >= buffer->count)
+        return 0;
+
+    /* replay the deltas up to the sample before offset */
+    sts3x_ring_buffer_cursor_init(buffer, &cursor);
+    for (i = 1; i < offset; ++i)
+        cursor.timestamp +=
+            buffer->entries[sts3x_ring_buffer_index(buffer, i)].timestamp_delta;
+    cursor.offset = offset;
+    return sts3x_ring_buffer_read_cursor(buffer, &cursor, samples,
+                                         max_samples);
+}
+
+void sts3x_ring_buffer_cursor_init(const struct sts3x_ring_buffer* buffer,
+                                   struct sts3x_ring_buffer_cursor* cursor) {
+    cursor->offset = 0;
+    cursor->timestamp = buffer->oldest_timestamp;
+}
+
+uint16_t sts3x_ring_buffer_read_cursor(const struct sts3x_ring_buffer* buffer,
+                                       struct sts3x_ring_buffer_cursor* cursor,
+                                       struct sts3x_sample* samples,
+                                       uint16_t max_samples) {
+    const struct sts3x_ring_buffer_entry* entry;
+    uint32_t timestamp = cursor->timestamp;
+    uint16_t num_samples;
+    uint16_t i;
+
+    if (cursor->offset >= buffer->count)
+        return 0;
+
+    num_samples = buffer->count - cursor->offset;
+    if (num_samples > max_samples)
+        num_samples = max_samples;
+
+    for (i = 0; i < num_samples; ++i) {
+        entry = &buffer->entries[sts3x_ring_buffer_index(
+            buffer, (uint16_t)(cursor->offset + i))];
+        /* the delta of the oldest sample refers to an overwritten one */
+        if (cursor->offset + i)
+            timestamp += entry->timestamp_delta;
+        else
+            timestamp = buffer->oldest_timestamp;
+        samples[i].timestamp = timestamp;
+        samples[i].temperature = sts3x_ticks_to_milli_celsius(entry->ticks);
+    }
+    cursor->offset += num_samples;
+    cursor->timestamp = timestamp;
+    return num_samples;
+}
+
+uint16_t sts3x_ring_buffer_drain(struct sts3x_ring_buffer* buffer,
+                                 struct sts3x_sample* samples,
+                                 uint16_t max_samples) {
+    uint16_t num_samples = sts3x_ring_buffer_read(buffer, 0, samples,
+                                                  max_samples);
+    uint16_t i;
+
+    for (i = 0; i < num_samples; ++i)
+        sts3x_ring_buffer_drop_oldest(buffer);
+    return num_samples;
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion STS3x sample ring buffer
+ *
+ * Fixed capacity buffer for timestamped STS3x measurements which does not
+ * allocate memory. Samples are stored as raw 16 bit temperature signal and 16
+ * bit time difference to the previous sample, i.e. 4 bytes per sample, and are
+ * only converted to milli degree Celsius and absolute timestamps when they are
+ * copied out. When the buffer is full, the oldest sample is overwritten.
+ */
+
+#ifndef STS3X_RING_BUFFER_H
+#define STS3X_RING_BUFFER_H
+
+#include "sensirion_arch_config.h"
+#include "sts3x.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Decoded sample as returned by sts3x_ring_buffer_read() and
+ * sts3x_ring_buffer_drain().
+ */
+struct sts3x_sample {
+    uint32_t timestamp;  /* in the time unit passed to the buffer */
+    int32_t temperature; /* [degree Celsius], multiplied by 1000 */
+};
+
+/**
+ * Storage element of the ring buffer, provided by the caller.
+ */
+struct sts3x_ring_buffer_entry {
+    uint16_t ticks;           /* raw temperature signal S_T */
+    uint16_t timestamp_delta; /* time since the previous sample */
+};
+
+struct sts3x_ring_buffer {
+    struct sts3x_ring_buffer_entry* entries;
+    uint16_t capacity;
+    uint16_t head;  /* index of the oldest sample */
+    uint16_t count; /* number of stored samples */
+    uint32_t oldest_timestamp;
+    uint32_t newest_timestamp;
+};
+
+/**
+ * Read position in a ring buffer, see sts3x_ring_buffer_read_cursor().
+ */
+struct sts3x_ring_buffer_cursor {
+    uint16_t offset;    /* number of samples before the cursor */
+    uint32_t timestamp; /* timestamp of the sample before the cursor */
+};
+
+/**
+ * Initializes an empty ring buffer on caller provided storage.
+ *
+ * @param buffer    the ring buffer to initialize
+ * @param entries   storage for capacity samples
+ * @param capacity  number of samples the buffer can hold, at least 1
+ */
+void sts3x_ring_buffer_init(struct sts3x_ring_buffer* buffer,
+                            struct sts3x_ring_buffer_entry* entries,
+                            uint16_t capacity);
+
+/**
+ * Removes all samples from the ring buffer.
+ *
+ * @param buffer    the ring buffer
+ */
+void sts3x_ring_buffer_clear(struct sts3x_ring_buffer* buffer);
+
+/**
+ * Appends a sample to the ring buffer. If the buffer is full, the oldest sample
+ * is overwritten.
+ * Timestamps are expected to be monotonic, in any unit chosen by the caller
+ * (e.g. milliseconds), and may wrap around. The gap to the previous sample is
+ * stored in 16 bit, longer gaps are shortened to 65535 time units. Timestamps
+ * before the previous sample get the previous timestamp.
+ *
+ * @param buffer    the ring buffer
+ * @param ticks     the raw temperature signal S_T
+ * @param timestamp the time of the measurement
+ */
+void sts3x_ring_buffer_push(struct sts3x_ring_buffer* buffer, uint16_t ticks,
+                            uint32_t timestamp);
+
+/**
+ * Reads out the result of a measurement of the sensor instance and appends it
+ * to the ring buffer. In single shot mode the measurement must have been
+ * started with sts3x_measure_dev() before, in periodic mode the latest
+ * measurement is fetched.
+ *
+ * @param buffer    the ring buffer
+ * @param dev       the sensor instance
+ * @param timestamp the time of the measurement
+ * @return          0 if the command was successful, else an error code. No
+ *                  sample is added on errors.
+ */
+int16_t sts3x_ring_buffer_record_dev(struct sts3x_ring_buffer* buffer,
+                                     struct sts3x_dev* dev, uint32_t timestamp);
+
+/**
+ * Returns the number of samples in the ring buffer.
+ *
+ * @param buffer    the ring buffer
+ * @return          the number of stored samples
+ */
+uint16_t sts3x_ring_buffer_count(const struct sts3x_ring_buffer* buffer);
+
+/**
+ * Copies samples out of the ring buffer without removing them, oldest first.
+ * The timestamps are reconstructed from the oldest sample, so skipping offset
+ * samples costs as much as reading them. Use sts3x_ring_buffer_read_cursor()
+ * to iterate over the buffer in chunks.
+ *
+ * @param buffer        the ring buffer
+ * @param offset        number of (oldest) samples to skip
+ * @param samples       the address for the decoded samples
+ * @param max_samples   the number of elements in samples
+ * @return              the number of copied samples
+ */
+uint16_t sts3x_ring_buffer_read(const struct sts3x_ring_buffer* buffer,
+                                uint16_t offset, struct sts3x_sample* samples,
+                                uint16_t max_samples);
+
+/**
+ * Sets a cursor to the oldest sample of the ring buffer.
+ *
+ * @param buffer    the ring buffer
+ * @param cursor    the cursor to initialize
+ */
+void sts3x_ring_buffer_cursor_init(const struct sts3x_ring_buffer* buffer,
+                                   struct sts3x_ring_buffer_cursor* cursor);
+
+/**
+ * Copies the samples after the cursor out of the ring buffer without removing
+ * them, oldest first, and advances the cursor past them. Samples pushed after
+ * the cursor was set are read as well. The cursor is only valid until a
+ * sample is removed, i.e. until the buffer is drained or cleared or a push
+ * overwrites the oldest sample.
+ *
+ * @param buffer        the ring buffer
+ * @param cursor        the read position, see sts3x_ring_buffer_cursor_init()
+ * @param samples       the address for the decoded samples
+ * @param max_samples   the number of elements in samples
+ * @return              the number of copied samples
+ */
+uint16_t sts3x_ring_buffer_read_cursor(const struct sts3x_ring_buffer* buffer,
+                                       struct sts3x_ring_buffer_cursor* cursor,
+                                       struct sts3x_sample* samples,
+                                       uint16_t max_samples);
+
+/**
+ * Copies samples out of the ring buffer and removes them, oldest first.
+ *
+ * @param buffer        the ring buffer
+ * @param samples       the address for the decoded samples
+ * @param max_samples   the number of elements in samples
+ * @return              the number of copied samples
+ */
+uint16_t sts3x_ring_buffer_drain(struct sts3x_ring_buffer* buffer,
+                                 struct sts3x_sample* samples,
+                                 uint16_t max_samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STS3X_RING_BUFFER_H */
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Adaptive sampling of an STS3x within an energy budget, implementation
+ */
+
+#include "sts3x_scheduler.h"
+#include "sensirion_arch_config.h"
+#include "sts3x.h"
+
+#define STS3X_SCHEDULER_USEC_PER_SEC 1000000
+
+#ifdef STS3X_FIXED_REPEATABILITY
+#define STS3X_SCHEDULER_INITIAL_REPEATABILITY STS3X_FIXED_REPEATABILITY
+#else
+#define STS3X_SCHEDULER_INITIAL_REPEATABILITY 0
+#endif /* STS3X_FIXED_REPEATABILITY */
+
+/* repeatability of the temperature signal in milli degree Celsius for high,
+ * medium and low repeatability, see the datasheet */
+static const uint32_t STS3X_SCHEDULER_NOISE[] = {40, 80, 150};
+
+void sts3x_scheduler_init(struct sts3x_scheduler* scheduler,
+                          struct sts3x_dev* dev,
+                          const struct sts3x_scheduler_config* config) {
+    uint8_t repeatability;
+
+    for (repeatability = 0; repeatability < 3; ++repeatability)
+        scheduler->cost_usec[repeatability] =
+            sts3x_get_measurement_duration_usec_for(repeatability) +
+            config->overhead_usec;
+
+    scheduler->dev = dev;
+    scheduler->config = config;
+    scheduler->interval_usec = config->min_interval_usec;
+    scheduler->repeatability = STS3X_SCHEDULER_INITIAL_REPEATABILITY;
+    scheduler->rate = 0;
+    scheduler->samples = 0;
+    scheduler->active_usec = 0;
+    scheduler->credit_usec = (int32_t)config->burst_usec;
+    scheduler->last_temperature = 0;
+    scheduler->last_at_usec = 0;
+    scheduler->due_at_usec = 0;
+    scheduler->started = 0;
+}
+
+/* credit earned within elapsed_usec, capped at the burst size */
+static int32_t sts3x_scheduler_refill(const struct sts3x_scheduler* scheduler,
+                                      uint32_t elapsed_usec) {
+    const struct sts3x_scheduler_config* config = scheduler->config;
+    int64_t credit = scheduler->credit_usec +
+                     (int64_t)config->budget_ppm * elapsed_usec /
+                         STS3X_SCHEDULER_USEC_PER_SEC;
+
+    if (credit > (int64_t)config->burst_usec)
+        return (int32_t)config->burst_usec;
+    return (int32_t)credit;
+}
+
+/* smoothed rate of change: follows increases at once and decays slowly */
+static void sts3x_scheduler_update_rate(struct sts3x_scheduler* scheduler,
+                                        uint32_t elapsed_usec,
+                                        int32_t temperature) {
+    const uint32_t noise = STS3X_SCHEDULER_NOISE[scheduler->repeatability];
+    uint32_t change = temperature > scheduler->last_temperature
+                          ? (uint32_t)(temperature -
+                                       scheduler->last_temperature)
+                          : (uint32_t)(scheduler->last_temperature -
+                                       temperature);
+    uint64_t rate;
+
+    if (!elapsed_usec)
+        return;
+    /* changes within the noise of the measurement are no changes */
+    change = change > noise ? change - noise : 0;
+    rate = (uint64_t)change * STS3X_SCHEDULER_USEC_PER_SEC / elapsed_usec;
+    if (rate > UINT32_MAX)
+        rate = UINT32_MAX;
+
+    if (rate >= scheduler->rate)
+        scheduler->rate = (uint32_t)rate;
+    else
+        scheduler->rate -= (scheduler->rate - (uint32_t)rate + 3) >> 2;
+}
+
+static uint32_t
+sts3x_scheduler_next_interval(const struct sts3x_scheduler* scheduler) {
+    const struct sts3x_scheduler_config* config = scheduler->config;
+    uint64_t interval = config->max_interval_usec;
+
+    if (scheduler->rate)
+        interval = (uint64_t)config->resolution * STS3X_SCHEDULER_USEC_PER_SEC /
+                   scheduler->rate;
+    /* grow slowly, a change may just be pausing */
+    if (interval > 2 * (uint64_t)scheduler->interval_usec)
+        interval = 2 * (uint64_t)scheduler->interval_usec;
+    if (interval > config->max_interval_usec)
+        interval = config->max_interval_usec;
+    if (interval < config->min_interval_usec)
+        interval = config->min_interval_usec;
+    return (uint32_t)interval;
+}
+
+static void sts3x_scheduler_update(struct sts3x_scheduler* scheduler,
+                                   uint32_t now, int32_t temperature) {
+    const struct sts3x_scheduler_config* config = scheduler->config;
+    const uint32_t cost = scheduler->cost_usec[scheduler->repeatability];
+    uint64_t interval;
+#ifndef STS3X_FIXED_REPEATABILITY
+    uint64_t allowed_noise;
+#endif /* STS3X_FIXED_REPEATABILITY */
+    int32_t credit;
+    uint8_t repeatability;
+
+    if (scheduler->samples) {
+        sts3x_scheduler_update_rate(scheduler, now - scheduler->last_at_usec,
+                                    temperature);
+        scheduler->credit_usec =
+            sts3x_scheduler_refill(scheduler, now - scheduler->last_at_usec);
+    }
+    scheduler->credit_usec -= (int32_t)cost;
+    scheduler->active_usec += cost;
+    scheduler->samples++;
+    scheduler->last_temperature = temperature;
+    scheduler->last_at_usec = now;
+
+    interval = sts3x_scheduler_next_interval(scheduler);
+
+#ifdef STS3X_FIXED_REPEATABILITY
+    repeatability = STS3X_FIXED_REPEATABILITY;
+#else
+    /* cheapest repeatability whose noise does not hide the resolution or the
+     * expected change until the next measurement */
+    allowed_noise = scheduler->rate * interval / STS3X_SCHEDULER_USEC_PER_SEC;
+    if (allowed_noise < (uint64_t)config->resolution)
+        allowed_noise = (uint64_t)config->resolution;
+    repeatability = 2;
+    while (repeatability > 0 &&
+           2 * (uint64_t)STS3X_SCHEDULER_NOISE[repeatability] > allowed_noise)
+        repeatability--;
+#endif /* STS3X_FIXED_REPEATABILITY */
+
+    if (config->budget_ppm) {
+        credit = sts3x_scheduler_refill(scheduler, (uint32_t)interval);
+#ifndef STS3X_FIXED_REPEATABILITY
+        /* lower the repeatability first and then wait for enough credit */
+        while (repeatability < 2 &&
+               credit < (int32_t)scheduler->cost_usec[repeatability])
+            repeatability++;
+#endif /* STS3X_FIXED_REPEATABILITY */
+        if (credit < (int32_t)scheduler->cost_usec[repeatability]) {
+            const uint64_t deficit = (uint64_t)(
+                (int64_t)scheduler->cost_usec[repeatability] - credit);
+
+            /* wait until the missing credit is earned, but not longer than
+             * the longest interval */
+            interval +=
+                deficit * STS3X_SCHEDULER_USEC_PER_SEC / config->budget_ppm + 1;
+            if (interval > config->max_interval_usec)
+                interval = config->max_interval_usec;
+        }
+    }
+
+    scheduler->interval_usec = (uint32_t)interval;
+    scheduler->repeatability = repeatability;
+    scheduler->due_at_usec = now + scheduler->interval_usec;
+}
+
+int16_t sts3x_scheduler_poll(struct sts3x_scheduler* scheduler,
+                             sts3x_clock_usec_fn clock, int32_t* temperature,
+                             uint32_t* next_due_usec) {
+    const uint32_t now = clock();
+    uint8_t repeatability;
+    int16_t ret;
+
+    /* signed difference to handle the wrap around of the clock */
+    if (scheduler->started &&
+        (int32_t)(now - scheduler->due_at_usec) < 0) {
+        *next_due_usec = scheduler->due_at_usec;
+        return STATUS_IN_PROGRESS;
+    }
+    scheduler->started = 1;
+
+    /* the repeatability of the sensor is only changed for the measurement */
+    repeatability = scheduler->dev->repeatability;
+    sts3x_set_repeatability_dev(scheduler->dev, scheduler->repeatability);
+    ret = sts3x_measure_blocking_read_dev(scheduler->dev, temperature);
+    sts3x_set_repeatability_dev(scheduler->dev, repeatability);
+    if (ret) {
+        scheduler->due_at_usec = now + scheduler->config->min_interval_usec;
+        *next_due_usec = scheduler->due_at_usec;
+        return ret;
+    }
+
+    sts3x_scheduler_update(scheduler, now, *temperature);
+    *next_due_usec = scheduler->due_at_usec;
+    return STATUS_OK;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Adaptive sampling of an STS3x within an energy budget
+ *
+ * Replaces a fixed measurement loop on battery powered devices: the scheduler
+ * measures rarely and with low repeatability where possible and reports when
+ * the next measurement is due, so the device can sleep in between.
+ *
+ * The interval follows the rate of change of the temperature: it is chosen so
+ * that the temperature changes by about the configured resolution between two
+ * measurements. It shrinks at once when the temperature starts to change and
+ * grows by at most a factor of two per measurement while it is stable. The
+ * repeatability is the cheapest one whose noise is small compared to the
+ * resolution or to the expected change per interval.
+ *
+ * The energy budget limits the average fraction of time the sensor measures
+ * and the bus is busy. Credit for stable periods is saved up to a burst size
+ * and spent on fast changes. Once the credit is used up, the repeatability is
+ * lowered and then the interval is extended, up to the longest interval. A
+ * budget that does not cover one measurement per longest interval is exceeded.
+ */
+
+#ifndef STS3X_SCHEDULER_H
+#define STS3X_SCHEDULER_H
+
+#include "sensirion_arch_config.h"
+#include "sts3x.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Parameters of the adaptive sampling, see sts3x_scheduler_init().
+ */
+struct sts3x_scheduler_config {
+    uint32_t min_interval_usec; /* shortest interval, during fast changes */
+    uint32_t max_interval_usec; /* longest interval, while stable */
+    int32_t resolution;         /* milli degree Celsius between measurements */
+    /* average fraction of time spent measuring in parts per million, 0 for
+     * no limit */
+    uint32_t budget_ppm;
+    uint32_t burst_usec;    /* credit saved for fast changes */
+    uint32_t overhead_usec; /* bus and wake up time per measurement */
+};
+
+/* 0.1 degree Celsius, 1 to 60 seconds, on average 0.2% of the time active */
+#define STS3X_SCHEDULER_CONFIG_DEFAULT \
+    { 1000000, 60000000, 100, 2000, 200000, 1000 }
+
+/**
+ * Adaptive sampling state of a sensor, see sts3x_scheduler_init().
+ */
+struct sts3x_scheduler {
+    struct sts3x_dev* dev;
+    const struct sts3x_scheduler_config* config;
+    uint32_t interval_usec; /* interval to the next measurement */
+    uint8_t repeatability;  /* of the next measurement */
+    uint32_t rate;          /* rate of change, milli degree Celsius / s */
+    uint32_t samples;       /* measurements so far */
+    uint64_t active_usec;   /* time spent measuring, incl. overhead */
+    /* internal state, see sts3x_scheduler_poll() */
+    uint32_t cost_usec[3]; /* per measurement, by repeatability */
+    int32_t credit_usec;
+    int32_t last_temperature;
+    uint32_t last_at_usec;
+    uint32_t due_at_usec;
+    uint8_t started;
+};
+
+/**
+ * Prepares the adaptive sampling of a sensor. The scheduler sets the
+ * repeatability of the sensor for each measurement and restores it afterwards,
+ * with STS3X_FIXED_REPEATABILITY only the interval adapts.
+ *
+ * @param scheduler the scheduler to initialize
+ * @param dev       the sensor instance, in single shot mode
+ * @param config    the parameters, must stay valid while the scheduler is in
+ *                  use
+ */
+void sts3x_scheduler_init(struct sts3x_scheduler* scheduler,
+                          struct sts3x_dev* dev,
+                          const struct sts3x_scheduler_config* config);
+
+/**
+ * Measures if a measurement is due and schedules the next one. Call it again
+ * at the reported time at the latest, e.g. after sleeping until then. The
+ * first call measures right away.
+ *
+ * The measurement blocks for the measurement duration of the chosen
+ * repeatability, see sts3x_measure_blocking_read_dev().
+ *
+ * @param scheduler     the scheduler
+ * @param clock         the monotonic clock
+ * @param temperature   the address for the temperature in milli degree
+ *                      Celsius, set if 0 is returned
+ * @param next_due_usec the address for the time the next measurement is due,
+ *                      always set
+ * @return              0 if a measurement was read out, STATUS_IN_PROGRESS if
+ *                      no measurement is due yet, else the error code of the
+ *                      measurement. After errors, the next measurement is due
+ *                      after the shortest interval.
+ */
+int16_t sts3x_scheduler_poll(struct sts3x_scheduler* scheduler,
+                             sts3x_clock_usec_fn clock, int32_t* temperature,
+                             uint32_t* next_due_usec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STS3X_SCHEDULER_H */
@@ -0,0 +1,131 @@
+#include "sensirion_temperature_filter.h"
+#include "sensirion_test_setup.h"
+
+#define WINDOW_SIZE 7
+#define NUM_SAMPLES 1000
+
+/* deterministic pseudo random temperatures between -45 and 130 degree C */
+static int32_t sample(uint32_t i) {
+    uint32_t x = i * 2654435761u;
+
+    x ^= x >> 15;
+    return -45000 + (int32_t)(x % 175001);
+}
+
+TEST_GROUP (TemperatureFilterTestGroup){};
+
+TEST (TemperatureFilterTestGroup, EmaFollowsStep) {
+    struct sensirion_ema ema;
+    int32_t average = 0;
+    int i;
+
+    sensirion_ema_init(&ema, 3);
+    CHECK_EQUAL_TEXT(-12345, sensirion_ema_update(&ema, -12345),
+                     "first sample initializes the average");
+    CHECK_EQUAL_TEXT(-12345, sensirion_ema_update(&ema, -12345),
+                     "constant input is exact");
+
+    /* a step is followed to ~63% after 2^shift samples */
+    sensirion_ema_init(&ema, 3);
+    sensirion_ema_update(&ema, 20000);
+    for (i = 0; i < 8; ++i)
+        average = sensirion_ema_update(&ema, 30000);
+    CHECK_TRUE_TEXT(average > 26000 && average < 27000, "step response");
+    for (i = 0; i < 200; ++i)
+        average = sensirion_ema_update(&ema, 30000);
+    CHECK_EQUAL_TEXT(30000, average, "settled");
+    CHECK_EQUAL_TEXT(30000, sensirion_ema_get(&ema), "sensirion_ema_get");
+
+    sensirion_ema_init(&ema, 0);
+    sensirion_ema_update(&ema, 1000);
+    CHECK_EQUAL_TEXT(-2000, sensirion_ema_update(&ema, -2000),
+                     "no smoothing");
+}
+
+TEST (TemperatureFilterTestGroup, WindowMatchesNaiveAggregation) {
+    struct sensirion_window_entry entries[WINDOW_SIZE];
+    struct sensirion_window window;
+    int32_t values[NUM_SAMPLES];
+    int32_t min, max;
+    int64_t sum, mean;
+    uint32_t i, j, first;
+
+    sensirion_window_init(&window, entries, WINDOW_SIZE);
+    for (i = 0; i < NUM_SAMPLES; ++i) {
+        /* runs of rising, falling and equal values stress the queues */
+        if (i % 50 < 10)
+            values[i] = (int32_t)(i % 50) * 100;
+        else if (i % 50 < 20)
+            values[i] = (int32_t)(20 - i % 50) * 100;
+        else if (i % 50 < 25)
+            values[i] = 1234;
+        else
+            values[i] = sample(i);
+        sensirion_window_update(&window, values[i]);
+
+        first = i + 1 >= WINDOW_SIZE ? i + 1 - WINDOW_SIZE : 0;
+        min = max = values[first];
+        sum = 0;
+        for (j = first; j <= i; ++j) {
+            if (values[j] < min)
+                min = values[j];
+            if (values[j] > max)
+                max = values[j];
+            sum += values[j];
+        }
+        mean = (2 * sum + (sum < 0 ? -1 : 1) * (int64_t)(i + 1 - first)) /
+               (2 * (int64_t)(i + 1 - first));
+
+        CHECK_EQUAL_TEXT(i + 1 - first, sensirion_window_count(&window),
+                         "sensirion_window_count");
+        CHECK_EQUAL_TEXT(min, sensirion_window_min(&window),
+                         "sensirion_window_min");
+        CHECK_EQUAL_TEXT(max, sensirion_window_max(&window),
+                         "sensirion_window_max");
+        CHECK_EQUAL_TEXT(mean, sensirion_window_mean(&window),
+                         "sensirion_window_mean");
+    }
+}
+
+TEST (TemperatureFilterTestGroup, WindowOfOne) {
+    struct sensirion_window_entry entry;
+    struct sensirion_window window;
+
+    sensirion_window_init(&window, &entry, 1);
+    sensirion_window_update(&window, 5000);
+    sensirion_window_update(&window, -7000);
+    CHECK_EQUAL_TEXT(1, sensirion_window_count(&window), "count");
+    CHECK_EQUAL_TEXT(-7000, sensirion_window_min(&window), "min");
+    CHECK_EQUAL_TEXT(-7000, sensirion_window_max(&window), "max");
+    CHECK_EQUAL_TEXT(-7000, sensirion_window_mean(&window), "mean");
+}
+
+TEST (TemperatureFilterTestGroup, DeadbandReportsChanges) {
+    struct sensirion_deadband deadband;
+    int reports = 0;
+    int i;
+
+    sensirion_deadband_init(&deadband, 100, 0);
+    CHECK_TRUE_TEXT(sensirion_deadband_update(&deadband, 20000),
+                    "first sample");
+    CHECK_FALSE_TEXT(sensirion_deadband_update(&deadband, 20100),
+                     "change within the deadband");
+    CHECK_FALSE_TEXT(sensirion_deadband_update(&deadband, 19900),
+                     "change within the deadband");
+    CHECK_TRUE_TEXT(sensirion_deadband_update(&deadband, 20101),
+                    "change above the deadband");
+    CHECK_TRUE_TEXT(sensirion_deadband_update(&deadband, 20000),
+                    "change below the deadband");
+
+    /* slow drift is reported once it exceeds the deadband */
+    for (i = 1; i <= 1000; ++i)
+        reports += sensirion_deadband_update(&deadband, 20000 + i * 10);
+    CHECK_EQUAL_TEXT(1000 / 11, reports, "drift reports");
+
+    /* sign of life after max_skipped samples */
+    sensirion_deadband_init(&deadband, 100, 9);
+    reports = 0;
+    for (i = 0; i < 100; ++i)
+        reports += sensirion_deadband_update(&deadband, 20000);
+    CHECK_EQUAL_TEXT(10, reports, "max_skipped");
+}
@@ -0,0 +1,199 @@
+#include "sensirion_temperature_unit_conversion.h"
+#include "sensirion_test_setup.h"
+
+#define NUM_TICKS 0x10000
+
+static int32_t ticks_to_celsius(uint16_t ticks) {
+    return ((21875 * (int32_t)ticks) >> 13) - 45000;
+}
+
+TEST_GROUP (TemperatureConversionTestGroup) {
+    uint16_t* ticks;
+    int32_t* celsius;
+    int32_t* fahrenheit;
+
+    void setup() {
+        uint32_t i;
+
+        ticks = new uint16_t[NUM_TICKS];
+        celsius = new int32_t[NUM_TICKS];
+        fahrenheit = new int32_t[NUM_TICKS];
+        for (i = 0; i < NUM_TICKS; ++i)
+            ticks[i] = (uint16_t)i;
+    }
+
+    void teardown() {
+        delete[] ticks;
+        delete[] celsius;
+        delete[] fahrenheit;
+    }
+};
+
+TEST (TemperatureConversionTestGroup, TicksToCelsiusBulkIsBitExact) {
+    uint32_t i;
+
+    sensirion_ticks_to_celsius_bulk(ticks, celsius, NUM_TICKS);
+    for (i = 0; i < NUM_TICKS; ++i)
+        CHECK_EQUAL_TEXT(ticks_to_celsius(ticks[i]), celsius[i],
+                         "sensirion_ticks_to_celsius_bulk");
+}
+
+TEST (TemperatureConversionTestGroup, TicksToFahrenheitBulkIsBitExact) {
+    uint32_t i;
+
+    sensirion_ticks_to_fahrenheit_bulk(ticks, fahrenheit, NUM_TICKS);
+    for (i = 0; i < NUM_TICKS; ++i)
+        CHECK_EQUAL_TEXT(
+            sensirion_celsius_to_fahrenheit(ticks_to_celsius(ticks[i])),
+            fahrenheit[i], "sensirion_ticks_to_fahrenheit_bulk");
+}
+
+TEST (TemperatureConversionTestGroup, CelsiusToFahrenheitBulkIsBitExact) {
+    int32_t value;
+    uint32_t i;
+
+    /* whole valid input range, including negative temperatures */
+    for (i = 0; i < NUM_TICKS; ++i)
+        celsius[i] = -291000 + (int32_t)(i * 582000 / (NUM_TICKS - 1));
+
+    sensirion_celsius_to_fahrenheit_bulk(celsius, fahrenheit, NUM_TICKS);
+    for (i = 0; i < NUM_TICKS; ++i) {
+        value = sensirion_celsius_to_fahrenheit(celsius[i]);
+        CHECK_EQUAL_TEXT(value, fahrenheit[i],
+                         "sensirion_celsius_to_fahrenheit_bulk");
+    }
+
+    /* in place conversion */
+    sensirion_celsius_to_fahrenheit_bulk(celsius, celsius, NUM_TICKS);
+    for (i = 0; i < NUM_TICKS; ++i)
+        CHECK_EQUAL_TEXT(fahrenheit[i], celsius[i],
+                         "sensirion_celsius_to_fahrenheit_bulk in place");
+}
+
+TEST (TemperatureConversionTestGroup, UnalignedBulkConversion) {
+    uint32_t offset;
+    uint32_t count;
+    uint32_t i;
+
+    /* cover the vectorized body as well as the scalar remainder */
+    for (offset = 0; offset < 8; ++offset) {
+        for (count = 0; count < 20; ++count) {
+            for (i = 0; i < NUM_TICKS; ++i)
+                celsius[i] = 0x7FFFFFFF;
+
+            sensirion_ticks_to_celsius_bulk(&ticks[40000 + offset],
+                                            &celsius[offset], count);
+            for (i = 0; i < count; ++i)
+                CHECK_EQUAL_TEXT(ticks_to_celsius(ticks[40000 + offset + i]),
+                                 celsius[offset + i],
+                                 "sensirion_ticks_to_celsius_bulk unaligned");
+            CHECK_EQUAL_TEXT(0x7FFFFFFF, celsius[offset + count],
+                             "sensirion_ticks_to_celsius_bulk overrun");
+        }
+    }
+}
+
+TEST (TemperatureConversionTestGroup, CalibratedConversionIsAccurate) {
+    /* offset in milli degree Celsius and gain in millionths, from typical
+     * corrections to the limits of the coefficients */
+    static const int32_t coefficients[][2] = {
+        {0, SENSIRION_CALIBRATION_GAIN_ONE},
+        {-250, 1002500},
+        {1234, 997000},
+        {8000000, SENSIRION_CALIBRATION_GAIN_ONE},
+        {-8000000, SENSIRION_CALIBRATION_GAIN_ONE},
+        {0, SENSIRION_CALIBRATION_GAIN_MAX},
+        {-6000000, SENSIRION_CALIBRATION_GAIN_MAX},
+        {45000, 1},
+    };
+    struct sensirion_temperature_calibration calibration;
+    double exact;
+    double error;
+    uint32_t c;
+    uint32_t i;
+
+    for (c = 0; c < sizeof(coefficients) / sizeof(coefficients[0]); ++c) {
+        CHECK_ZERO_TEXT(sensirion_temperature_calibration_init(
+                            &calibration, c, coefficients[c][0],
+                            coefficients[c][1]),
+                        "sensirion_temperature_calibration_init");
+        sensirion_ticks_to_celsius_calibrated_bulk(ticks, celsius, NUM_TICKS,
+                                                   &calibration);
+        /* full range of the signal, -45 to 130 degree Celsius */
+        for (i = 0; i < NUM_TICKS; ++i) {
+            exact = (175000.0 * i / 65536.0 - 45000.0) * coefficients[c][1] /
+                        1e6 +
+                    coefficients[c][0];
+            error = sensirion_ticks_to_celsius_calibrated(ticks[i],
+                                                          &calibration) -
+                    exact;
+            CHECK_TRUE_TEXT(error > -1.01 && error < 0.01,
+                            "sensirion_ticks_to_celsius_calibrated");
+            CHECK_EQUAL_TEXT(sensirion_ticks_to_celsius_calibrated(
+                                 ticks[i], &calibration),
+                             celsius[i],
+                             "sensirion_ticks_to_celsius_calibrated_bulk");
+        }
+    }
+}
+
+TEST (TemperatureConversionTestGroup, UncalibratedConversionIsBitExact) {
+    static const struct sensirion_temperature_calibration calibration =
+        SENSIRION_TEMPERATURE_CALIBRATION(0x12345678, 0,
+                                          SENSIRION_CALIBRATION_GAIN_ONE);
+    uint32_t i;
+
+    for (i = 0; i < NUM_TICKS; ++i)
+        CHECK_EQUAL_TEXT(
+            ticks_to_celsius(ticks[i]),
+            sensirion_ticks_to_celsius_calibrated(ticks[i], &calibration),
+            "sensirion_ticks_to_celsius_calibrated");
+}
+
+TEST (TemperatureConversionTestGroup, CalibrationTable) {
+    static const struct sensirion_temperature_calibration table[] = {
+        SENSIRION_TEMPERATURE_CALIBRATION(0x1000, -250, 1002500),
+        SENSIRION_TEMPERATURE_CALIBRATION(0xFFFFFFFF, 1234, 997000),
+        SENSIRION_TEMPERATURE_CALIBRATION(0, 0, 1000000),
+    };
+    struct sensirion_temperature_calibration calibration;
+
+    CHECK_TRUE_TEXT(&table[1] ==
+                        sensirion_temperature_calibration_find(table, 3,
+                                                               0xFFFFFFFF),
+                    "sensirion_temperature_calibration_find");
+    CHECK_TRUE_TEXT(&table[2] ==
+                        sensirion_temperature_calibration_find(table, 3, 0),
+                    "sensirion_temperature_calibration_find");
+    CHECK_TRUE_TEXT(NULL == sensirion_temperature_calibration_find(table, 2, 0),
+                    "unknown serial");
+
+    /* the initializer matches the checked initialization */
+    CHECK_ZERO_TEXT(sensirion_temperature_calibration_init(&calibration, 0x1000,
+                                                           -250, 1002500),
+                    "sensirion_temperature_calibration_init");
+    CHECK_EQUAL_TEXT(table[0].serial, calibration.serial, "serial");
+    CHECK_EQUAL_TEXT(table[0].slope, calibration.slope, "slope");
+    CHECK_EQUAL_TEXT(table[0].intercept, calibration.intercept, "intercept");
+
+    CHECK_EQUAL_TEXT(-1,
+                     sensirion_temperature_calibration_init(&calibration, 1, 0,
+                                                            0),
+                     "gain 0");
+    CHECK_EQUAL_TEXT(-1,
+                     sensirion_temperature_calibration_init(
+                         &calibration, 1, 0,
+                         SENSIRION_CALIBRATION_GAIN_MAX + 1),
+                     "gain too large");
+    CHECK_EQUAL_TEXT(-1,
+                     sensirion_temperature_calibration_init(
+                         &calibration, 1, 9000000,
+                         SENSIRION_CALIBRATION_GAIN_ONE),
+                     "offset too large");
+    CHECK_EQUAL_TEXT(-1,
+                     sensirion_temperature_calibration_init(
+                         &calibration, 1, -0x7FFFFFFF,
+                         SENSIRION_CALIBRATION_GAIN_ONE),
+                     "offset too small");
+    CHECK_EQUAL_TEXT(0x1000, calibration.serial, "unchanged on errors");
+}
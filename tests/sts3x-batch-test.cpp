@@ -0,0 +1,269 @@
+#include "sensirion_test_setup.h"
+#include "sts3x_batch.h"
+
+#define BUFFER_SIZE 1024
+#define NUM_SAMPLES 200
+#define SERIAL 0x12345678
+#define BASE_TIMESTAMP 1000000
+
+static uint8_t buffer[2 * BUFFER_SIZE];
+
+/* slowly drifting temperature, measured once per second */
+static uint16_t slow_ticks(uint16_t i) {
+    return (uint16_t)(25000 + (i % 40 < 20 ? i % 40 : 40 - i % 40) * 3);
+}
+
+static uint16_t encode_slow(uint8_t* batch, uint16_t size, uint16_t samples) {
+    struct sts3x_batch_encoder encoder;
+    uint16_t i;
+
+    CHECK_ZERO_TEXT(sts3x_batch_encoder_init(&encoder, batch, size, SERIAL, 2,
+                                             BASE_TIMESTAMP),
+                    "sts3x_batch_encoder_init");
+    for (i = 0; i < samples; ++i) {
+        CHECK_ZERO_TEXT(sts3x_batch_encoder_add(&encoder, slow_ticks(i),
+                                                BASE_TIMESTAMP + i * 1000u),
+                        "sts3x_batch_encoder_add");
+    }
+    return sts3x_batch_encoder_finish(&encoder);
+}
+
+TEST_GROUP (BatchTestGroup){};
+
+TEST (BatchTestGroup, RoundtripSlowSignal) {
+    struct sts3x_batch_decoder decoder;
+    struct sts3x_batch_header header;
+    uint16_t ticks[NUM_SAMPLES];
+    uint32_t timestamps[NUM_SAMPLES];
+    size_t batch_length;
+    uint16_t length;
+    uint16_t i;
+
+    length = encode_slow(buffer, BUFFER_SIZE, NUM_SAMPLES);
+    /* the first sample is a large jump from 0 and the time is in ms */
+    CHECK_TRUE_TEXT(length <= STS3X_BATCH_HEADER_SIZE + STS3X_BATCH_CRC_SIZE +
+                                  3 * NUM_SAMPLES + 1,
+                    "encoded size");
+
+    CHECK_ZERO_TEXT(sts3x_batch_decoder_init(&decoder, buffer, length, &header,
+                                             &batch_length),
+                    "sts3x_batch_decoder_init");
+    CHECK_EQUAL_TEXT(length, batch_length, "batch length");
+    CHECK_EQUAL_TEXT(STS3X_BATCH_VERSION, header.version, "version");
+    CHECK_EQUAL_TEXT(2, header.repeatability, "repeatability");
+    CHECK_EQUAL_TEXT(NUM_SAMPLES, header.count, "count");
+    CHECK_EQUAL_TEXT(SERIAL, header.serial, "serial");
+    CHECK_EQUAL_TEXT(BASE_TIMESTAMP, header.base_timestamp, "base timestamp");
+
+    /* decode in chunks */
+    for (i = 0; i < NUM_SAMPLES; i += 64) {
+        CHECK_EQUAL_TEXT(NUM_SAMPLES - i < 64 ? NUM_SAMPLES - i : 64,
+                         sts3x_batch_decode(&decoder, &ticks[i],
+                                            &timestamps[i], 64),
+                         "sts3x_batch_decode");
+    }
+    CHECK_ZERO_TEXT(sts3x_batch_decode(&decoder, ticks, timestamps, 64),
+                    "all samples decoded");
+    for (i = 0; i < NUM_SAMPLES; ++i) {
+        CHECK_EQUAL_TEXT(slow_ticks(i), ticks[i], "ticks");
+        CHECK_EQUAL_TEXT(BASE_TIMESTAMP + i * 1000u, timestamps[i],
+                         "timestamp");
+    }
+}
+
+TEST (BatchTestGroup, TwoBytesPerSample) {
+    struct sts3x_batch_encoder encoder;
+    uint16_t i;
+
+    sts3x_batch_encoder_init(&encoder, buffer, BUFFER_SIZE, SERIAL, 0, 0);
+    sts3x_batch_encoder_add(&encoder, slow_ticks(0), 0);
+    for (i = 1; i <= NUM_SAMPLES; ++i)
+        sts3x_batch_encoder_add(&encoder, slow_ticks(i), i * 100u);
+    CHECK_EQUAL_TEXT(STS3X_BATCH_HEADER_SIZE + STS3X_BATCH_CRC_SIZE + 3 + 1 +
+                         2 * NUM_SAMPLES,
+                     sts3x_batch_encoder_finish(&encoder), "encoded size");
+}
+
+TEST (BatchTestGroup, RoundtripExtremes) {
+    static const uint16_t input_ticks[] = {0xFFFF, 0, 0xFFFF, 0x8000, 0x7FFF,
+                                           0x7FFF, 1,      0xFFFE, 0};
+    static const uint32_t input_timestamps[] = {
+        0, 0, 1, 127, 128, 16511, 0x7FFFFFFF, 0xFFFFFFFE, 0xFFFFFFFF};
+    const uint16_t num = sizeof(input_ticks) / sizeof(input_ticks[0]);
+    struct sts3x_batch_encoder encoder;
+    struct sts3x_batch_decoder decoder;
+    struct sts3x_batch_header header;
+    uint16_t ticks[16];
+    uint32_t timestamps[16];
+    size_t batch_length;
+    uint16_t length;
+    uint16_t i;
+
+    sts3x_batch_encoder_init(&encoder, buffer, BUFFER_SIZE, 0xFFFFFFFF, 0xFF,
+                             0);
+    for (i = 0; i < num; ++i) {
+        CHECK_ZERO_TEXT(sts3x_batch_encoder_add(&encoder, input_ticks[i],
+                                                input_timestamps[i]),
+                        "sts3x_batch_encoder_add");
+    }
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA,
+                     sts3x_batch_encoder_add(&encoder, 0, 0xFFFFFFFE),
+                     "timestamp going backwards");
+    length = sts3x_batch_encoder_finish(&encoder);
+
+    CHECK_ZERO_TEXT(sts3x_batch_decoder_init(&decoder, buffer, length, &header,
+                                             &batch_length),
+                    "sts3x_batch_decoder_init");
+    CHECK_EQUAL_TEXT(0xFFFFFFFF, header.serial, "serial");
+    CHECK_EQUAL_TEXT(num, sts3x_batch_decode(&decoder, ticks, timestamps, 16),
+                     "sts3x_batch_decode");
+    for (i = 0; i < num; ++i) {
+        CHECK_EQUAL_TEXT(input_ticks[i], ticks[i], "ticks");
+        CHECK_EQUAL_TEXT(input_timestamps[i], timestamps[i], "timestamp");
+    }
+}
+
+TEST (BatchTestGroup, TimestampsWrapAround) {
+    struct sts3x_batch_encoder encoder;
+    struct sts3x_batch_decoder decoder;
+    struct sts3x_batch_header header;
+    uint16_t ticks[8];
+    uint32_t timestamps[8];
+    size_t batch_length;
+    uint16_t length;
+    uint16_t i;
+
+    sts3x_batch_encoder_init(&encoder, buffer, BUFFER_SIZE, SERIAL, 0,
+                             0xFFFFFC00);
+    for (i = 0; i < 8; ++i) {
+        CHECK_ZERO_TEXT(sts3x_batch_encoder_add(&encoder, slow_ticks(i),
+                                                0xFFFFFC00 + i * 256u),
+                        "sts3x_batch_encoder_add across the wrap");
+    }
+    /* a gap of 2^31 can not be told apart from going backwards */
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA,
+                     sts3x_batch_encoder_add(&encoder, 0,
+                                             0xFFFFFC00 + 7 * 256u +
+                                                 0x80000000u),
+                     "ambiguous gap");
+    length = sts3x_batch_encoder_finish(&encoder);
+    /* constant interval after the wrap, no large differences */
+    CHECK_EQUAL_TEXT(STS3X_BATCH_HEADER_SIZE + STS3X_BATCH_CRC_SIZE + 3 + 1 +
+                         7 * 3,
+                     length, "encoded size");
+
+    CHECK_ZERO_TEXT(sts3x_batch_decoder_init(&decoder, buffer, length, &header,
+                                             &batch_length),
+                    "sts3x_batch_decoder_init");
+    CHECK_EQUAL_TEXT(8, sts3x_batch_decode(&decoder, ticks, timestamps, 8),
+                     "sts3x_batch_decode");
+    for (i = 0; i < 8; ++i) {
+        CHECK_EQUAL_TEXT(slow_ticks(i), ticks[i], "ticks");
+        CHECK_EQUAL_TEXT(0xFFFFFC00 + i * 256u, timestamps[i], "timestamp");
+    }
+}
+
+TEST (BatchTestGroup, FullBatch) {
+    struct sts3x_batch_encoder encoder;
+    struct sts3x_batch_decoder decoder;
+    struct sts3x_batch_header header;
+    uint16_t ticks[8];
+    uint32_t timestamps[8];
+    size_t batch_length;
+    uint16_t length;
+
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA,
+                     sts3x_batch_encoder_init(&encoder, buffer,
+                                              STS3X_BATCH_HEADER_SIZE, SERIAL,
+                                              0, 0),
+                     "buffer too small");
+
+    /* room for the first sample (3 + 1 bytes) and one more (1 + 1 bytes) */
+    sts3x_batch_encoder_init(&encoder, buffer,
+                             STS3X_BATCH_HEADER_SIZE + STS3X_BATCH_CRC_SIZE + 6,
+                             SERIAL, 0, 0);
+    CHECK_ZERO_TEXT(sts3x_batch_encoder_add(&encoder, 20000, 0), "first");
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA,
+                     sts3x_batch_encoder_add(&encoder, 30000, 1),
+                     "large difference does not fit");
+    CHECK_ZERO_TEXT(sts3x_batch_encoder_add(&encoder, 20001, 1),
+                    "small difference fits");
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA,
+                     sts3x_batch_encoder_add(&encoder, 20001, 2), "full");
+    CHECK_EQUAL_TEXT(2, sts3x_batch_encoder_count(&encoder), "count");
+    length = sts3x_batch_encoder_finish(&encoder);
+    CHECK_EQUAL_TEXT(STS3X_BATCH_HEADER_SIZE + STS3X_BATCH_CRC_SIZE + 6,
+                     length, "length");
+
+    CHECK_ZERO_TEXT(sts3x_batch_decoder_init(&decoder, buffer, length, &header,
+                                             &batch_length),
+                    "sts3x_batch_decoder_init");
+    CHECK_EQUAL_TEXT(2, sts3x_batch_decode(&decoder, ticks, timestamps, 8),
+                     "sts3x_batch_decode");
+    CHECK_EQUAL_TEXT(20001, ticks[1], "ticks");
+}
+
+TEST (BatchTestGroup, DetectsCorruption) {
+    struct sts3x_batch_decoder decoder;
+    struct sts3x_batch_header header;
+    size_t batch_length;
+    uint16_t length;
+    uint16_t i;
+    uint8_t bit;
+
+    length = encode_slow(buffer, BUFFER_SIZE, 20);
+
+    /* every single bit error is detected */
+    for (i = 0; i < length; ++i) {
+        for (bit = 0; bit < 8; ++bit) {
+            buffer[i] ^= (uint8_t)(1 << bit);
+            CHECK_TRUE_TEXT(sts3x_batch_decoder_init(&decoder, buffer, length,
+                                                     &header, &batch_length),
+                            "corrupted batch");
+            buffer[i] ^= (uint8_t)(1 << bit);
+        }
+    }
+
+    buffer[STS3X_BATCH_HEADER_SIZE + 10] ^= 0x10;
+    CHECK_EQUAL_TEXT(STATUS_CRC_FAIL,
+                     sts3x_batch_decoder_init(&decoder, buffer, length, &header,
+                                              &batch_length),
+                     "sample data corrupted");
+    buffer[STS3X_BATCH_HEADER_SIZE + 10] ^= 0x10;
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA,
+                     sts3x_batch_decoder_init(&decoder, buffer, length - 1,
+                                              &header, &batch_length),
+                     "truncated");
+    CHECK_ZERO_TEXT(sts3x_batch_decoder_init(&decoder, buffer, length, &header,
+                                             &batch_length),
+                    "restored");
+}
+
+TEST (BatchTestGroup, ConcatenatedBatches) {
+    struct sts3x_batch_decoder decoder;
+    struct sts3x_batch_header header;
+    uint16_t ticks[NUM_SAMPLES];
+    uint32_t timestamps[NUM_SAMPLES];
+    size_t batch_length;
+    size_t offset = 0;
+    size_t total;
+    uint16_t batches = 0;
+    uint32_t samples = 0;
+
+    total = encode_slow(buffer, BUFFER_SIZE, NUM_SAMPLES);
+    total += encode_slow(&buffer[total], BUFFER_SIZE, 5);
+    total += encode_slow(&buffer[total], BUFFER_SIZE, 0);
+
+    while (offset < total) {
+        CHECK_ZERO_TEXT(sts3x_batch_decoder_init(&decoder, &buffer[offset],
+                                                 total - offset, &header,
+                                                 &batch_length),
+                        "sts3x_batch_decoder_init");
+        samples += sts3x_batch_decode(&decoder, ticks, timestamps, NUM_SAMPLES);
+        offset += batch_length;
+        batches++;
+    }
+    CHECK_EQUAL_TEXT(total, offset, "all batches decoded");
+    CHECK_EQUAL_TEXT(3, batches, "batches");
+    CHECK_EQUAL_TEXT(NUM_SAMPLES + 5, samples, "samples");
+}
@@ -0,0 +1,328 @@
+/*
+ * Benchmark of the STS3x driver acquisition paths against the simulated bus.
+ *
+ * For every path and repeatability the benchmark reports the cost per sample:
+ * bus transactions, bytes on the wire, sleeps (i.e. CPU wakeups), time on the
+ * bus, the latency distribution in simulated time and the host CPU time spent
+ * in the driver and the simulation. The report is written as JSON to stdout.
+ *
+ * In addition, recorded temperature traces are replayed with a fixed 1 s
+ * measurement loop and with the adaptive scheduler (sts3x_scheduler.h) to
+ * report the savings in wakeups, bus time and active time of the sensor, and
+ * the largest difference between the trace and the latest reading.
+ *
+ * Usage: ./sts3x-bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sensirion_common.h"
+#include "sensirion_sim_i2c.h"
+#include "sts3x-trace-replay.h"
+#include "sts3x.h"
+#include "sts3x_scheduler.h"
+
+#define BENCH_DEFAULT_ITERATIONS 1000
+#define BENCH_BATCH_SIZE 8
+#define BENCH_MUX_ADDRESS SENSIRION_SIM_I2C_DEFAULT_MUX_ADDRESS
+
+struct bench_path {
+    const char* name;
+    uint8_t uses_repeatability;
+    uint16_t samples_per_call; /* sensors read per call */
+    void (*prepare)(void);
+    int16_t (*run)(void);
+    void (*finish)(void);
+};
+
+static struct sts3x_i2c_mux_channel default_channel = {BENCH_MUX_ADDRESS, 0};
+static struct sts3x_dev batch_devs[BENCH_BATCH_SIZE];
+static struct sts3x_i2c_mux_channel batch_channels[BENCH_BATCH_SIZE];
+static uint8_t bench_repeatability;
+
+static int16_t run_blocking_read(void) {
+    int32_t temperature;
+    return sts3x_measure_blocking_read(&temperature);
+}
+
+static int16_t run_polling_read(void) {
+    int32_t temperature;
+    return sts3x_measure_polling_read(&temperature);
+}
+
+static int16_t run_measure_read(void) {
+    int32_t temperature;
+    int16_t ret = sts3x_measure();
+    if (ret)
+        return ret;
+    sensirion_sleep_usec(sts3x_get_measurement_duration_usec());
+    return sts3x_read(&temperature);
+}
+
+static int16_t run_poll(void) {
+    int32_t temperature;
+    uint32_t ready_at_usec;
+    int16_t ret;
+
+    /* an event loop would serve other tasks until ready_at_usec */
+    while ((ret = sts3x_measure_poll(sensirion_sim_i2c_clock_usec,
+                                     &temperature, &ready_at_usec)) ==
+           STATUS_IN_PROGRESS)
+        sensirion_sleep_usec(ready_at_usec - sensirion_sim_i2c_clock_usec());
+    return ret;
+}
+
+static void prepare_periodic(void) {
+    sts3x_start_periodic_measurement(STS3X_MEASUREMENT_RATE_10_MPS);
+}
+
+static int16_t run_periodic(void) {
+    int32_t temperature;
+    return sts3x_periodic_blocking_read(&temperature);
+}
+
+static void finish_periodic(void) {
+    sts3x_stop_periodic_measurement();
+}
+
+static void prepare_batch(void) {
+    uint8_t i;
+
+    sensirion_sim_i2c_remove_devices();
+    for (i = 0; i < BENCH_BATCH_SIZE; ++i) {
+        sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_DEFAULT, i, i);
+        batch_channels[i].mux_address = BENCH_MUX_ADDRESS;
+        batch_channels[i].channel = i;
+        sts3x_init_dev(&batch_devs[i], STS3X_ADDRESS_DEFAULT);
+        sts3x_set_repeatability_dev(&batch_devs[i], bench_repeatability);
+        batch_devs[i].select_bus = sts3x_select_i2c_mux_channel;
+        batch_devs[i].bus = &batch_channels[i];
+    }
+}
+
+static int16_t run_batch(void) {
+    int32_t temperatures[BENCH_BATCH_SIZE];
+    int16_t status[BENCH_BATCH_SIZE];
+    return sts3x_measure_blocking_read_batch(batch_devs, BENCH_BATCH_SIZE,
+                                             temperatures, status);
+}
+
+static int16_t run_sequential(void) {
+    int32_t temperature;
+    int16_t ret = STATUS_OK;
+    uint8_t i;
+
+    for (i = 0; i < BENCH_BATCH_SIZE && ret == STATUS_OK; ++i)
+        ret = sts3x_measure_blocking_read_dev(&batch_devs[i], &temperature);
+    return ret;
+}
+
+static int16_t run_read_serial(void) {
+    uint32_t serial;
+    return sts3x_read_serial(&serial);
+}
+
+static int16_t run_probe(void) {
+    return sts3x_probe();
+}
+
+static const struct bench_path bench_paths[] = {
+    {"measure_blocking_read", 1, 1, NULL, run_blocking_read, NULL},
+    {"measure_polling_read", 1, 1, NULL, run_polling_read, NULL},
+    {"measure_read", 1, 1, NULL, run_measure_read, NULL},
+    {"measure_poll", 1, 1, NULL, run_poll, NULL},
+    {"periodic_10mps", 1, 1, prepare_periodic, run_periodic, finish_periodic},
+    {"sequential_8_sensors", 1, BENCH_BATCH_SIZE, prepare_batch, run_sequential,
+     NULL},
+    {"batch_8_sensors", 1, BENCH_BATCH_SIZE, prepare_batch, run_batch, NULL},
+    {"read_serial", 0, 1, NULL, run_read_serial, NULL},
+    {"probe", 0, 1, NULL, run_probe, NULL},
+};
+
+static const struct recorded_trace* const bench_traces[] = {
+    &window_sill_trace,
+    &cold_room_trace,
+};
+
+#define BENCH_OVERHEAD_USEC 1000
+
+struct bench_schedule {
+    const char* name;
+    struct sts3x_scheduler_config config; /* unused for the fixed loop */
+};
+
+static const struct bench_schedule bench_schedules[] = {
+    {"fixed_1s", {0, 0, 0, 0, 0, 0}},
+    {"adaptive_10s", {1000000, 10000000, 100, 0, 0, BENCH_OVERHEAD_USEC}},
+    {"adaptive_default", STS3X_SCHEDULER_CONFIG_DEFAULT},
+};
+
+/* the first schedule is the fixed loop the others are compared to */
+static void bench_replay(const struct recorded_trace* trace,
+                         const struct bench_schedule* schedule,
+                         struct trace_replay_result* result) {
+    struct sts3x_scheduler scheduler;
+    struct sts3x_dev dev;
+
+    sensirion_sim_i2c_reset();
+    sensirion_i2c_init();
+    sts3x_select_i2c_mux_channel(&default_channel);
+    sts3x_init_dev(&dev, STS3X_ADDRESS_DEFAULT);
+    if (schedule != bench_schedules)
+        sts3x_scheduler_init(&scheduler, &dev, &schedule->config);
+
+    replay_recorded_trace(trace, &dev,
+                          schedule != bench_schedules ? &scheduler : NULL,
+                          BENCH_OVERHEAD_USEC, result);
+}
+
+static void bench_schedules_run(void) {
+    struct trace_replay_result fixed = {0, 0, 0, 0, 0, 0};
+    struct trace_replay_result result;
+    size_t i;
+    size_t j;
+    int first = 1;
+
+    printf(",\n \"schedules\": [\n");
+    for (i = 0; i < sizeof(bench_traces) / sizeof(bench_traces[0]); ++i) {
+        for (j = 0; j < sizeof(bench_schedules) / sizeof(bench_schedules[0]);
+             ++j) {
+            bench_replay(bench_traces[i], &bench_schedules[j], &result);
+            if (j == 0)
+                fixed = result;
+
+            printf("%s    {\"trace\": \"%s\", \"schedule\": \"%s\", "
+                   "\"wakeups\": %u, \"bus_usec\": %llu, "
+                   "\"active_usec\": %llu, \"max_error\": %d,\n",
+                   first ? "" : ",\n", bench_traces[i]->name,
+                   bench_schedules[j].name, result.wakeups,
+                   (unsigned long long)result.bus_usec,
+                   (unsigned long long)result.active_usec, result.max_error);
+            printf("     \"savings\": {\"wakeups\": %.2f, \"bus_usec\": %.2f, "
+                   "\"active_usec\": %.2f}}",
+                   (double)fixed.wakeups / result.wakeups,
+                   (double)fixed.bus_usec /
+                       (double)(result.bus_usec ? result.bus_usec : 1),
+                   (double)fixed.active_usec /
+                       (double)(result.active_usec ? result.active_usec : 1));
+            first = 0;
+        }
+    }
+    printf("\n]");
+}
+
+static int compare_uint64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t* sorted, uint32_t count,
+                           uint32_t percent) {
+    return sorted[(uint64_t)(count - 1) * percent / 100];
+}
+
+static uint64_t host_nsec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_run(const struct bench_path* path, uint8_t repeatability,
+                      uint32_t iterations, uint64_t* latencies, int first) {
+    struct sensirion_sim_i2c_stats stats;
+    uint64_t sim_start;
+    uint64_t sim_total;
+    uint64_t host_start;
+    uint64_t host_total;
+    uint32_t errors = 0;
+    uint32_t samples;
+    uint32_t i;
+
+    sensirion_sim_i2c_reset();
+    sensirion_i2c_init();
+    sts3x_select_i2c_mux_channel(&default_channel);
+    bench_repeatability = repeatability;
+    sts3x_set_repeatability(repeatability);
+    if (path->prepare)
+        path->prepare();
+    sensirion_sim_i2c_reset_stats();
+
+    sim_start = sensirion_sim_i2c_now_usec();
+    host_start = host_nsec();
+    for (i = 0; i < iterations; ++i) {
+        uint64_t start = sensirion_sim_i2c_now_usec();
+        if (path->run() != STATUS_OK)
+            errors++;
+        latencies[i] = sensirion_sim_i2c_now_usec() - start;
+    }
+    host_total = host_nsec() - host_start;
+    sim_total = sensirion_sim_i2c_now_usec() - sim_start;
+    sensirion_sim_i2c_get_stats(&stats);
+
+    if (path->finish)
+        path->finish();
+
+    qsort(latencies, iterations, sizeof(*latencies), compare_uint64);
+    samples = iterations * path->samples_per_call;
+
+    printf("%s    {\"path\": \"%s\", \"repeatability\": %d, "
+           "\"samples\": %u, \"errors\": %u,\n",
+           first ? "" : ",\n", path->name,
+           path->uses_repeatability ? repeatability : -1, samples, errors);
+    printf("     \"samples_per_second\": %.2f,\n",
+           (double)samples * 1e6 / (double)(sim_total ? sim_total : 1));
+    printf("     \"latency_usec\": {\"p50\": %llu, \"p90\": %llu, "
+           "\"p99\": %llu, \"max\": %llu},\n",
+           (unsigned long long)percentile(latencies, iterations, 50),
+           (unsigned long long)percentile(latencies, iterations, 90),
+           (unsigned long long)percentile(latencies, iterations, 99),
+           (unsigned long long)latencies[iterations - 1]);
+    printf("     \"per_sample\": {\"transactions\": %.2f, "
+           "\"bytes\": %.2f, \"nacks\": %.2f, \"wakeups\": %.2f, "
+           "\"sleep_usec\": %.1f, \"bus_usec\": %.1f, "
+           "\"host_cpu_nsec\": %.1f}}",
+           (double)stats.transactions / samples,
+           (double)(stats.bytes_written + stats.bytes_read) / samples,
+           (double)stats.nacks / samples, (double)stats.sleeps / samples,
+           (double)stats.slept_usec / samples,
+           (double)stats.bus_usec / samples, (double)host_total / samples);
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = BENCH_DEFAULT_ITERATIONS;
+    uint64_t* latencies;
+    uint8_t repeatability;
+    size_t i;
+    int first = 1;
+
+    if (argc > 1)
+        iterations = (uint32_t)strtoul(argv[1], NULL, 10);
+    if (iterations == 0)
+        iterations = 1;
+
+    latencies = (uint64_t*)malloc(iterations * sizeof(*latencies));
+    if (!latencies)
+        return 1;
+
+    printf("{\"driver_version\": \"%s\", \"bus_frequency_hz\": 100000, "
+           "\"iterations\": %u,\n \"results\": [\n",
+           sts3x_get_driver_version(), iterations);
+    for (i = 0; i < sizeof(bench_paths) / sizeof(bench_paths[0]); ++i) {
+        for (repeatability = 0; repeatability < 3; ++repeatability) {
+            bench_run(&bench_paths[i], repeatability, iterations, latencies,
+                      first);
+            first = 0;
+            if (!bench_paths[i].uses_repeatability)
+                break;
+        }
+    }
+    printf("\n]");
+    bench_schedules_run();
+    printf("}\n");
+
+    free(latencies);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "sensirion_test_setup.h"
+#include "sts3x.h"
+#include "sts3x_ring_buffer.h"
+
+TEST_GROUP (RingBufferTestGroup){};
+
+TEST (RingBufferTestGroup, TimestampsWrapAround) {
+    struct sts3x_ring_buffer_entry entries[4];
+    struct sts3x_ring_buffer buffer;
+    struct sts3x_sample samples[4];
+    uint16_t count;
+
+    sts3x_ring_buffer_init(&buffer, entries, 4);
+    sts3x_ring_buffer_push(&buffer, 0x6000, 0xFFFFFF00);
+    sts3x_ring_buffer_push(&buffer, 0x6001, 0xFFFFFFF0);
+    sts3x_ring_buffer_push(&buffer, 0x6002, 0x00000010);
+    /* before the previous sample: stored with the previous timestamp */
+    sts3x_ring_buffer_push(&buffer, 0x6003, 0x00000008);
+
+    count = sts3x_ring_buffer_read(&buffer, 0, samples, 4);
+    CHECK_EQUAL_TEXT(4, count, "sts3x_ring_buffer_read");
+    CHECK_EQUAL_TEXT(0xFFFFFF00, samples[0].timestamp, "timestamp 0");
+    CHECK_EQUAL_TEXT(0xFFFFFFF0, samples[1].timestamp, "timestamp 1");
+    CHECK_EQUAL_TEXT(0x00000010, samples[2].timestamp, "across the wrap");
+    CHECK_EQUAL_TEXT(0x00000010, samples[3].timestamp, "going backwards");
+    CHECK_EQUAL_TEXT(sts3x_ticks_to_milli_celsius(0x6002),
+                     samples[2].temperature, "temperature");
+}
+
+TEST (RingBufferTestGroup, DropsOldestAndClampsGaps) {
+    struct sts3x_ring_buffer_entry entries[3];
+    struct sts3x_ring_buffer buffer;
+    struct sts3x_sample samples[3];
+    uint16_t count;
+
+    sts3x_ring_buffer_init(&buffer, entries, 3);
+    sts3x_ring_buffer_push(&buffer, 0x6000, 1000);
+    sts3x_ring_buffer_push(&buffer, 0x6001, 2000);
+    /* gaps over 16 bit are shortened to 0xFFFF */
+    sts3x_ring_buffer_push(&buffer, 0x6002, 2000 + 0x10000);
+    sts3x_ring_buffer_push(&buffer, 0x6003, 2000 + 0x10000 + 10);
+    CHECK_EQUAL_TEXT(3, sts3x_ring_buffer_count(&buffer), "count when full");
+
+    count = sts3x_ring_buffer_read(&buffer, 0, samples, 3);
+    CHECK_EQUAL_TEXT(3, count, "sts3x_ring_buffer_read");
+    CHECK_EQUAL_TEXT(2000, samples[0].timestamp, "oldest sample dropped");
+    CHECK_EQUAL_TEXT(sts3x_ticks_to_milli_celsius(0x6001),
+                     samples[0].temperature, "oldest temperature");
+    CHECK_EQUAL_TEXT(2000 + 0xFFFF, samples[1].timestamp, "clamped gap");
+    CHECK_EQUAL_TEXT(2000 + 0x10000 + 10, samples[2].timestamp,
+                     "back on time after the clamped gap");
+}
+
+TEST (RingBufferTestGroup, IterateAndDrain) {
+    struct sts3x_ring_buffer_entry entries[8];
+    struct sts3x_ring_buffer buffer;
+    struct sts3x_sample samples[3];
+    uint16_t offset;
+    uint16_t count;
+    uint16_t i;
+
+    sts3x_ring_buffer_init(&buffer, entries, 8);
+    /* wrap the storage: 12 samples in 8 entries, 4 .. 11 remain */
+    for (i = 0; i < 12; ++i)
+        sts3x_ring_buffer_push(&buffer, (uint16_t)(0x6000 + i), 100u * i);
+
+    offset = 0;
+    while ((count = sts3x_ring_buffer_read(&buffer, offset, samples, 3))) {
+        for (i = 0; i < count; ++i)
+            CHECK_EQUAL_TEXT(100u * (4 + offset + i), samples[i].timestamp,
+                             "iterated timestamp");
+        offset += count;
+    }
+    CHECK_EQUAL_TEXT(8, offset, "iterated samples");
+    CHECK_EQUAL_TEXT(8, sts3x_ring_buffer_count(&buffer), "read keeps");
+
+    count = sts3x_ring_buffer_drain(&buffer, samples, 3);
+    CHECK_EQUAL_TEXT(3, count, "sts3x_ring_buffer_drain");
+    CHECK_EQUAL_TEXT(400, samples[0].timestamp, "drained oldest");
+    CHECK_EQUAL_TEXT(5, sts3x_ring_buffer_count(&buffer), "after drain");
+    count = sts3x_ring_buffer_read(&buffer, 0, samples, 1);
+    CHECK_EQUAL_TEXT(1, count, "read after drain");
+    CHECK_EQUAL_TEXT(700, samples[0].timestamp, "oldest after drain");
+}
+
+TEST (RingBufferTestGroup, CursorFollowsPushes) {
+    struct sts3x_ring_buffer_entry entries[8];
+    struct sts3x_ring_buffer_cursor cursor;
+    struct sts3x_ring_buffer buffer;
+    struct sts3x_sample samples[3];
+    uint16_t read;
+    uint16_t count;
+    uint16_t i;
+
+    sts3x_ring_buffer_init(&buffer, entries, 8);
+    /* 4 .. 9 remain, the oldest delta refers to an overwritten sample */
+    for (i = 0; i < 10; ++i)
+        sts3x_ring_buffer_push(&buffer, (uint16_t)(0x6000 + i), 100u * i);
+    sts3x_ring_buffer_drain(&buffer, samples, 2);
+
+    sts3x_ring_buffer_cursor_init(&buffer, &cursor);
+    read = 0;
+    while ((count = sts3x_ring_buffer_read_cursor(&buffer, &cursor, samples,
+                                                  3))) {
+        for (i = 0; i < count; ++i) {
+            CHECK_EQUAL_TEXT(100u * (4 + read + i), samples[i].timestamp,
+                             "iterated timestamp");
+            CHECK_EQUAL_TEXT(sts3x_ticks_to_milli_celsius(
+                                 (uint16_t)(0x6004 + read + i)),
+                             samples[i].temperature, "iterated temperature");
+        }
+        read += count;
+    }
+    CHECK_EQUAL_TEXT(6, read, "iterated samples");
+
+    /* samples pushed later are read from the same cursor */
+    sts3x_ring_buffer_push(&buffer, 0x600A, 1050);
+    count = sts3x_ring_buffer_read_cursor(&buffer, &cursor, samples, 3);
+    CHECK_EQUAL_TEXT(1, count, "sts3x_ring_buffer_read_cursor after push");
+    CHECK_EQUAL_TEXT(1050, samples[0].timestamp, "pushed timestamp");
+    count = sts3x_ring_buffer_read(&buffer, 6, samples, 3);
+    CHECK_EQUAL_TEXT(1, count, "sts3x_ring_buffer_read at offset");
+    CHECK_EQUAL_TEXT(1050, samples[0].timestamp, "same timestamp by offset");
+}
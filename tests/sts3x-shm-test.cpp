@@ -0,0 +1,109 @@
+#include "sensirion_test_setup.h"
+#include "sts3x_shm.h"
+
+#define SHM_TEST_NAME "/sts3x-shm-test"
+
+TEST_GROUP (STS3xShmTestGroup) {
+    struct sts3x_shm writer;
+    struct sts3x_shm reader;
+
+    void setup() {
+        int16_t ret = sts3x_shm_create(&writer, SHM_TEST_NAME, 2, 5);
+        CHECK_ZERO_TEXT(ret, "sts3x_shm_create");
+    }
+
+    void teardown() {
+        sts3x_shm_close(&writer);
+        sts3x_shm_unlink(SHM_TEST_NAME);
+    }
+
+    void publish(uint16_t sensor, int32_t temperature, uint64_t timestamp) {
+        struct sts3x_shm_reading reading;
+
+        reading.timestamp_usec = timestamp;
+        reading.temperature = temperature;
+        reading.status = STATUS_OK;
+        reading.sensor = sensor;
+        sts3x_shm_publish(&writer, &reading);
+    }
+};
+
+TEST (STS3xShmTestGroup, OpenBeforeStartFails) {
+    int16_t ret = sts3x_shm_open(&reader, SHM_TEST_NAME);
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA, ret, "sts3x_shm_open before start");
+
+    sts3x_shm_start(&writer);
+    ret = sts3x_shm_open(&reader, SHM_TEST_NAME);
+    CHECK_ZERO_TEXT(ret, "sts3x_shm_open");
+    sts3x_shm_close(&reader);
+}
+
+TEST (STS3xShmTestGroup, LatestReading) {
+    struct sts3x_shm_sensor_info info = {0x12345678, 500, 0x4A, 0x72, 3, 0};
+    struct sts3x_shm_sensor_info read_info;
+    struct sts3x_shm_reading reading;
+    int16_t ret;
+
+    sts3x_shm_set_sensor_info(&writer, 1, &info);
+    sts3x_shm_start(&writer);
+    ret = sts3x_shm_open(&reader, SHM_TEST_NAME);
+    CHECK_ZERO_TEXT(ret, "sts3x_shm_open");
+    CHECK_EQUAL_TEXT(2, sts3x_shm_num_sensors(&reader), "num_sensors");
+
+    ret = sts3x_shm_get_sensor_info(&reader, 1, &read_info);
+    CHECK_ZERO_TEXT(ret, "sts3x_shm_get_sensor_info");
+    CHECK_EQUAL_TEXT(0x12345678, read_info.serial, "serial");
+    CHECK_EQUAL_TEXT(3, read_info.mux_channel, "mux_channel");
+    ret = sts3x_shm_get_sensor_info(&reader, 2, &read_info);
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA, ret, "unknown sensor");
+
+    ret = sts3x_shm_read_latest(&reader, 0, &reading);
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA, ret, "no reading yet");
+
+    publish(0, 21000, 100);
+    publish(1, 22000, 200);
+    publish(0, 23000, 300);
+
+    ret = sts3x_shm_read_latest(&reader, 0, &reading);
+    CHECK_ZERO_TEXT(ret, "sts3x_shm_read_latest");
+    CHECK_EQUAL_TEXT(23000, reading.temperature, "latest temperature");
+    CHECK_EQUAL_TEXT(300, reading.timestamp_usec, "latest timestamp");
+    ret = sts3x_shm_read_latest(&reader, 1, &reading);
+    CHECK_ZERO_TEXT(ret, "sts3x_shm_read_latest");
+    CHECK_EQUAL_TEXT(22000, reading.temperature, "latest temperature");
+    CHECK_EQUAL_TEXT(1, reading.sensor, "sensor index");
+    sts3x_shm_close(&reader);
+}
+
+TEST (STS3xShmTestGroup, RingReportsLostReadings) {
+    struct sts3x_shm_reading readings[16];
+    uint64_t lost = 0;
+    uint32_t count;
+    int16_t ret;
+    int32_t i;
+
+    sts3x_shm_start(&writer);
+    ret = sts3x_shm_open(&reader, SHM_TEST_NAME);
+    CHECK_ZERO_TEXT(ret, "sts3x_shm_open");
+
+    publish(0, 1, 1);
+    publish(1, 2, 2);
+    count = sts3x_shm_read(&reader, readings, 16, &lost);
+    CHECK_EQUAL_TEXT(2, count, "sts3x_shm_read");
+    CHECK_EQUAL_TEXT(0, lost, "no readings lost");
+    CHECK_EQUAL_TEXT(2, readings[1].temperature, "order of readings");
+    count = sts3x_shm_read(&reader, readings, 16, &lost);
+    CHECK_EQUAL_TEXT(0, count, "no new readings");
+
+    /* the capacity is rounded up to 8, the 4 oldest readings are lost */
+    for (i = 3; i <= 14; ++i)
+        publish(0, i, (uint64_t)i);
+    count = sts3x_shm_read(&reader, readings, 5, &lost);
+    CHECK_EQUAL_TEXT(5, count, "limited by max_readings");
+    CHECK_EQUAL_TEXT(4, lost, "lost readings");
+    CHECK_EQUAL_TEXT(7, readings[0].temperature, "oldest available reading");
+    count = sts3x_shm_read(&reader, readings, 16, &lost);
+    CHECK_EQUAL_TEXT(3, count, "remaining readings");
+    CHECK_EQUAL_TEXT(14, readings[2].temperature, "newest reading");
+    sts3x_shm_close(&reader);
+}
@@ -0,0 +1,1275 @@
+#include <pthread.h>
+#include <sched.h>
+
+#include "sensirion_common.h"
+#include "sensirion_sim_i2c.h"
+#include "sensirion_test_setup.h"
+#include "sts3x-trace-replay.h"
+#include "sts3x.h"
+#include "sts3x_ring_buffer.h"
+#include "sts3x_scheduler.h"
+#include "sts_ticket_lock.h"
+
+#define SIM_MUX_ADDRESS SENSIRION_SIM_I2C_DEFAULT_MUX_ADDRESS
+
+/* one LSB of the temperature signal is ~2.7 milli degree Celsius */
+#define CHECK_TEMPERATURE(expected, actual, text)                   \
+    CHECK_TRUE_TEXT((actual) >= (expected)-3 && (actual) <= (expected) + 3, \
+                    text)
+
+TEST_GROUP (STS3xSimTestGroup) {
+    void setup() {
+        int16_t ret;
+
+        sensirion_sim_i2c_reset();
+        sensirion_i2c_init();
+        ret = sensirion_i2c_mux_set_single_channel(SIM_MUX_ADDRESS, 0);
+        CHECK_ZERO_TEXT(ret, "sensirion_i2c_mux_set_single_channel");
+    }
+
+    void teardown() {
+        sts3x_set_repeatability(0);
+        sts3x_set_conversion(NULL, NULL);
+        sensirion_sim_i2c_reset();
+        sensirion_i2c_release();
+    }
+};
+
+TEST (STS3xSimTestGroup, SingleShotTiming) {
+    static const uint32_t typical_duration_usec[] = {12500, 4500, 2500};
+    int32_t temperature;
+    uint8_t repeatability;
+    int16_t ret;
+
+    sensirion_sim_i2c_set_temperature(0, 21500);
+    for (repeatability = 0; repeatability < 3; ++repeatability) {
+        sts3x_set_repeatability(repeatability);
+
+        ret = sts3x_measure();
+        CHECK_ZERO_TEXT(ret, "sts3x_measure");
+        sensirion_sleep_usec(typical_duration_usec[repeatability] / 2);
+        ret = sts3x_read(&temperature);
+        CHECK_TRUE_TEXT(ret != 0, "sts3x_read before the result is ready");
+
+        sensirion_sleep_usec(sts3x_get_measurement_duration_usec());
+        ret = sts3x_read(&temperature);
+        CHECK_ZERO_TEXT(ret, "sts3x_read");
+        CHECK_TEMPERATURE(21500, temperature, "sts3x_read");
+    }
+}
+
+TEST (STS3xSimTestGroup, PollingReadIsFasterThanBlockingRead) {
+    struct sensirion_sim_i2c_stats stats;
+    uint64_t blocking_slept_usec;
+    int32_t temperature;
+    int16_t ret;
+
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read");
+    sensirion_sim_i2c_get_stats(&stats);
+    blocking_slept_usec = stats.slept_usec;
+    CHECK_EQUAL_TEXT(STS3X_MEASUREMENT_DURATION_USEC, blocking_slept_usec,
+                     "sts3x_measure_blocking_read sleep");
+
+    sensirion_sim_i2c_reset_stats();
+    ret = sts3x_measure_polling_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_polling_read");
+    CHECK_TEMPERATURE(25000, temperature, "sts3x_measure_polling_read");
+    sensirion_sim_i2c_get_stats(&stats);
+    CHECK_TRUE_TEXT(stats.slept_usec < blocking_slept_usec,
+                    "sts3x_measure_polling_read sleep");
+}
+
+TEST (STS3xSimTestGroup, InjectedFaults) {
+    int32_t temperature;
+    uint32_t serial;
+    int16_t ret;
+
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_NACK, 1);
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_TRUE_TEXT(ret != 0, "sts3x_measure_blocking_read with NACK");
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read after NACK");
+
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_CRC, 1);
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_EQUAL_TEXT(STATUS_CRC_FAIL, ret,
+                     "sts3x_measure_blocking_read with CRC error");
+    ret = sts3x_read_serial(&serial);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_serial after CRC error");
+    CHECK_EQUAL_TEXT(0x12345678, serial, "sts3x_read_serial");
+
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_STUCK_BUS, 0);
+    ret = sts3x_probe();
+    CHECK_TRUE_TEXT(ret != 0, "sts3x_probe with stuck bus");
+    ret = sts3x_probe();
+    CHECK_TRUE_TEXT(ret != 0, "sts3x_probe with stuck bus");
+    sensirion_sim_i2c_bus_clear();
+    ret = sts3x_probe();
+    CHECK_ZERO_TEXT(ret, "sts3x_probe after bus clear");
+}
+
+TEST (STS3xSimTestGroup, PeriodicMeasurement) {
+    int32_t temperature;
+    uint64_t elapsed;
+    uint64_t start;
+    int16_t ret;
+    int i;
+
+    ret = sts3x_start_periodic_measurement(STS3X_MEASUREMENT_RATE_10_MPS);
+    CHECK_ZERO_TEXT(ret, "sts3x_start_periodic_measurement");
+
+    ret = sts3x_fetch_data(&temperature);
+    CHECK_TRUE_TEXT(ret != 0, "sts3x_fetch_data before the first result");
+
+    for (i = 0; i < 5; ++i) {
+        ret = sts3x_periodic_blocking_read(&temperature);
+        CHECK_ZERO_TEXT(ret, "sts3x_periodic_blocking_read");
+        CHECK_TEMPERATURE(25000, temperature, "sts3x_periodic_blocking_read");
+
+        ret = sts3x_fetch_data(&temperature);
+        CHECK_TRUE_TEXT(ret != 0, "sts3x_fetch_data without new result");
+    }
+
+    /* the read outs follow the clock of the sensor, the bus time does not
+     * add up and no measurement is read out twice */
+    start = sensirion_sim_i2c_now_usec();
+    for (i = 0; i < 20; ++i) {
+        ret = sts3x_periodic_blocking_read(&temperature);
+        CHECK_ZERO_TEXT(ret, "sts3x_periodic_blocking_read");
+    }
+    elapsed = sensirion_sim_i2c_now_usec() - start;
+    CHECK_TRUE_TEXT(elapsed > 19 * 100000 && elapsed <= 20 * 100000 + 1000,
+                    "one measurement per interval");
+
+    ret = sts3x_stop_periodic_measurement();
+    CHECK_ZERO_TEXT(ret, "sts3x_stop_periodic_measurement");
+    sensirion_sleep_usec(1000);
+    ret = sts3x_periodic_blocking_read(&temperature);
+    CHECK_EQUAL_TEXT(STATUS_NACK, ret, "sts3x_periodic_blocking_read stopped");
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read after periodic mode");
+}
+
+TEST (STS3xSimTestGroup, ArtFetchFollowsSensorInterval) {
+    struct sensirion_sim_i2c_stats stats;
+    uint32_t previous_timestamp = 0;
+    uint32_t timestamp_usec;
+    uint32_t ready_at_usec;
+    int32_t temperature;
+    int16_t ret;
+    int samples = 0;
+
+    ret = sts3x_start_periodic_measurement(STS3X_MEASUREMENT_RATE_ART);
+    CHECK_ZERO_TEXT(ret, "sts3x_start_periodic_measurement ART");
+
+    /* the first measurement is found by polling */
+    while ((ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec,
+                                          &temperature, &timestamp_usec,
+                                          &ready_at_usec)) ==
+           STATUS_IN_PROGRESS)
+        sensirion_sim_i2c_advance_usec(ready_at_usec -
+                                       sensirion_sim_i2c_clock_usec());
+    CHECK_ZERO_TEXT(ret, "sts3x_fetch_timestamped first");
+    CHECK_TEMPERATURE(25000, temperature, "sts3x_fetch_timestamped");
+
+    /* later ones are read out when due, without sleeping or NACKed polls */
+    sensirion_sim_i2c_reset_stats();
+    while (samples < 8) {
+        previous_timestamp = timestamp_usec;
+        ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec,
+                                      &temperature, &timestamp_usec,
+                                      &ready_at_usec);
+        CHECK_EQUAL_TEXT(STATUS_IN_PROGRESS, ret, "sts3x_fetch_timestamped");
+        CHECK_EQUAL_TEXT(previous_timestamp + 250000, ready_at_usec,
+                         "sts3x_fetch_timestamped ready time");
+        sensirion_sim_i2c_advance_usec(ready_at_usec -
+                                       sensirion_sim_i2c_clock_usec());
+        ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec,
+                                      &temperature, &timestamp_usec,
+                                      &ready_at_usec);
+        CHECK_ZERO_TEXT(ret, "sts3x_fetch_timestamped");
+        CHECK_EQUAL_TEXT(previous_timestamp + 250000, timestamp_usec,
+                         "sts3x_fetch_timestamped interval");
+        CHECK_TEMPERATURE(25000, temperature, "sts3x_fetch_timestamped");
+        samples++;
+    }
+    sensirion_sim_i2c_get_stats(&stats);
+    CHECK_ZERO_TEXT(stats.nacks, "sts3x_fetch_timestamped NACKs");
+    CHECK_ZERO_TEXT(stats.sleeps, "sts3x_fetch_timestamped sleeps");
+
+    /* a late read out skips to the latest measurement */
+    sensirion_sim_i2c_advance_usec(600000);
+    previous_timestamp = timestamp_usec;
+    ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec, &temperature,
+                                  &timestamp_usec, &ready_at_usec);
+    CHECK_ZERO_TEXT(ret, "sts3x_fetch_timestamped late");
+    CHECK_EQUAL_TEXT(previous_timestamp + 2 * 250000, timestamp_usec,
+                     "sts3x_fetch_timestamped late timestamp");
+
+    ret = sts3x_stop_periodic_measurement();
+    CHECK_ZERO_TEXT(ret, "sts3x_stop_periodic_measurement");
+}
+
+TEST (STS3xSimTestGroup, ArtFetchReportsMissingSensor) {
+    uint32_t timestamp_usec;
+    uint32_t ready_at_usec;
+    uint32_t due_at_usec;
+    int32_t temperature;
+    int16_t ret;
+    int polls;
+
+    ret = sts3x_start_periodic_measurement(STS3X_MEASUREMENT_RATE_ART);
+    CHECK_ZERO_TEXT(ret, "sts3x_start_periodic_measurement ART");
+    while ((ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec,
+                                          &temperature, &timestamp_usec,
+                                          &ready_at_usec)) ==
+           STATUS_IN_PROGRESS)
+        sensirion_sim_i2c_advance_usec(ready_at_usec -
+                                       sensirion_sim_i2c_clock_usec());
+    CHECK_ZERO_TEXT(ret, "sts3x_fetch_timestamped first");
+
+    /* a reset sensor acknowledges the command but never has a result */
+    sensirion_i2c_general_call_reset();
+    ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec, &temperature,
+                                  &timestamp_usec, &due_at_usec);
+    CHECK_EQUAL_TEXT(STATUS_IN_PROGRESS, ret, "sts3x_fetch_timestamped");
+    ready_at_usec = due_at_usec;
+    for (polls = 0; polls < 1000; ++polls) {
+        sensirion_sim_i2c_advance_usec(ready_at_usec -
+                                       sensirion_sim_i2c_clock_usec());
+        ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec,
+                                      &temperature, &timestamp_usec,
+                                      &ready_at_usec);
+        if (ret != STATUS_IN_PROGRESS)
+            break;
+    }
+    CHECK_EQUAL_TEXT(STATUS_NACK, ret, "sts3x_fetch_timestamped after reset");
+    CHECK_TRUE_TEXT(sensirion_sim_i2c_clock_usec() - due_at_usec <=
+                        2 * 250000 + 1000,
+                    "missing measurement detected after two intervals");
+
+    /* a removed sensor does not acknowledge the command */
+    ret = sts3x_start_periodic_measurement(STS3X_MEASUREMENT_RATE_ART);
+    CHECK_ZERO_TEXT(ret, "sts3x_start_periodic_measurement ART");
+    while ((ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec,
+                                          &temperature, &timestamp_usec,
+                                          &ready_at_usec)) ==
+           STATUS_IN_PROGRESS)
+        sensirion_sim_i2c_advance_usec(ready_at_usec -
+                                       sensirion_sim_i2c_clock_usec());
+    CHECK_ZERO_TEXT(ret, "sts3x_fetch_timestamped after restart");
+    sensirion_sim_i2c_remove_devices();
+    ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec, &temperature,
+                                  &timestamp_usec, &ready_at_usec);
+    CHECK_EQUAL_TEXT(STATUS_IN_PROGRESS, ret, "not due yet");
+    sensirion_sim_i2c_advance_usec(ready_at_usec -
+                                   sensirion_sim_i2c_clock_usec());
+    ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec, &temperature,
+                                  &timestamp_usec, &ready_at_usec);
+    CHECK_EQUAL_TEXT(STATUS_NACK, ret, "sts3x_fetch_timestamped removed");
+
+    sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_DEFAULT, 0, 0x12345678);
+    sensirion_sleep_usec(1000);
+    ret = sts3x_stop_periodic_measurement();
+    CHECK_ZERO_TEXT(ret, "sts3x_stop_periodic_measurement");
+}
+
+#if USE_SENSIRION_I2C_TRANSFER
+TEST (STS3xSimTestGroup, CombinedTransfer) {
+    struct sensirion_sim_i2c_stats stats;
+    int32_t temperature;
+    uint32_t serial;
+    int16_t ret;
+
+    ret = sts3x_start_periodic_measurement(STS3X_MEASUREMENT_RATE_10_MPS);
+    CHECK_ZERO_TEXT(ret, "sts3x_start_periodic_measurement");
+    sensirion_sleep_usec(100000);
+
+    /* fetch command and read out are one transaction */
+    sensirion_sim_i2c_reset_stats();
+    ret = sts3x_fetch_data(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_fetch_data");
+    CHECK_TEMPERATURE(25000, temperature, "sts3x_fetch_data");
+    sensirion_sim_i2c_get_stats(&stats);
+    CHECK_EQUAL_TEXT(1, stats.transactions, "sts3x_fetch_data transactions");
+
+    ret = sts3x_stop_periodic_measurement();
+    CHECK_ZERO_TEXT(ret, "sts3x_stop_periodic_measurement");
+
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_CRC, 1);
+    ret = sts3x_read_serial(&serial);
+    CHECK_EQUAL_TEXT(STATUS_CRC_FAIL, ret, "sts3x_read_serial with CRC error");
+    ret = sts3x_read_serial(&serial);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_serial");
+    CHECK_EQUAL_TEXT(0x12345678, serial, "sts3x_read_serial");
+}
+#endif /* USE_SENSIRION_I2C_TRANSFER */
+
+TEST (STS3xSimTestGroup, BatchMeasurementOverlapsConversions) {
+    struct sts3x_i2c_mux_channel channels[4];
+    struct sts3x_dev devs[4];
+    int32_t temperatures[4];
+    int16_t status[4];
+    uint64_t start;
+    int16_t device;
+    int16_t ret;
+    uint8_t i;
+
+    sensirion_sim_i2c_remove_devices();
+    for (i = 0; i < 4; ++i) {
+        device = sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_DEFAULT, i, i);
+        sensirion_sim_i2c_set_temperature(device, 20000 + i * 1000);
+
+        channels[i].mux_address = SIM_MUX_ADDRESS;
+        channels[i].channel = i;
+        sts3x_init_dev(&devs[i], STS3X_ADDRESS_DEFAULT);
+        devs[i].select_bus = sts3x_select_i2c_mux_channel;
+        devs[i].bus = &channels[i];
+    }
+
+    start = sensirion_sim_i2c_now_usec();
+    ret = sts3x_measure_blocking_read_batch(devs, 4, temperatures, status);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read_batch");
+    CHECK_TRUE_TEXT(sensirion_sim_i2c_now_usec() - start <
+                        2 * STS3X_MEASUREMENT_DURATION_USEC,
+                    "sts3x_measure_blocking_read_batch duration");
+    for (i = 0; i < 4; ++i) {
+        CHECK_ZERO_TEXT(status[i], "sts3x_measure_blocking_read_batch status");
+        CHECK_TEMPERATURE(20000 + i * 1000, temperatures[i],
+                          "sts3x_measure_blocking_read_batch temperature");
+    }
+
+    /* a missing sensor only fails its own measurement */
+    channels[2].channel = 7;
+    ret = sts3x_measure_blocking_read_batch(devs, 4, temperatures, status);
+    CHECK_TRUE_TEXT(ret != 0, "sts3x_measure_blocking_read_batch missing");
+    CHECK_TRUE_TEXT(status[2] != 0, "sts3x_measure_blocking_read_batch status");
+    CHECK_ZERO_TEXT(status[3], "sts3x_measure_blocking_read_batch status");
+}
+
+TEST (STS3xSimTestGroup, GeneralCallResetOnlyReachesSelectedChannels) {
+    struct sts3x_i2c_mux_channel channels[2];
+    struct sts3x_dev devs[2];
+    uint16_t status;
+    int16_t ret;
+    uint8_t i;
+
+    sensirion_sim_i2c_remove_devices();
+    for (i = 0; i < 2; ++i) {
+        sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_DEFAULT, i, i);
+        channels[i].mux_address = SIM_MUX_ADDRESS;
+        channels[i].channel = i;
+        sts3x_init_dev(&devs[i], STS3X_ADDRESS_DEFAULT);
+        devs[i].select_bus = sts3x_select_i2c_mux_channel;
+        devs[i].bus = &channels[i];
+        sensirion_sleep_usec(1000);
+        ret = sts3x_clear_status_dev(&devs[i]);
+        CHECK_ZERO_TEXT(ret, "sts3x_clear_status_dev");
+    }
+
+    ret = sensirion_i2c_mux_set_single_channel(SIM_MUX_ADDRESS, 0);
+    CHECK_ZERO_TEXT(ret, "sensirion_i2c_mux_set_single_channel");
+    sensirion_i2c_general_call_reset();
+    sensirion_sleep_usec(1000);
+
+    ret = sts3x_read_status_dev(&devs[0], &status);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_status_dev");
+    CHECK_TRUE_TEXT(status & STS3X_STATUS_RESET_DETECTED,
+                    "sensor on the selected channel is reset");
+    ret = sts3x_read_status_dev(&devs[1], &status);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_status_dev");
+    CHECK_FALSE_TEXT(status & STS3X_STATUS_RESET_DETECTED,
+                     "sensor behind a closed channel is not reset");
+}
+
+TEST (STS3xSimTestGroup, DiscoveryScansMuxChannelsAndCachesTable) {
+    static const uint8_t muxes[] = {SIM_MUX_ADDRESS, SIM_MUX_ADDRESS + 1};
+    const uint8_t num_muxes = 1; /* the second one is missing */
+    static const uint8_t addresses[] = {STS3X_ADDRESS_DEFAULT,
+                                        STS3X_ADDRESS_ALTERNATE};
+    static const uint8_t expected_channels[] = {2, 5, 7};
+    struct sts3x_discovery_table table;
+    struct sts3x_discovery_table cached;
+    struct sts3x_i2c_mux_channel mux_channel;
+    struct sts3x_dev dev;
+    uint64_t sequential_usec;
+    uint64_t discover_usec;
+    uint64_t start;
+    uint32_t serial;
+    uint8_t rescanned;
+    uint8_t mask;
+    uint8_t i;
+    int16_t ret;
+
+    sensirion_sim_i2c_remove_devices();
+    sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_ALTERNATE,
+                                SENSIRION_SIM_I2C_NO_MUX, 0x4B00);
+    for (i = 0; i < 3; ++i)
+        sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_DEFAULT, expected_channels[i],
+                                    0x4A00u + expected_channels[i]);
+
+    /* reference: probe every place one by one */
+    start = sensirion_sim_i2c_now_usec();
+    mux_channel.mux_address = SIM_MUX_ADDRESS;
+    for (mux_channel.channel = 0; mux_channel.channel < 8;
+         ++mux_channel.channel) {
+        for (i = 0; i < 2; ++i) {
+            sts3x_init_dev(&dev, addresses[i]);
+            dev.select_bus = sts3x_select_i2c_mux_channel;
+            dev.bus = &mux_channel;
+            if (sts3x_probe_dev(&dev) == STATUS_OK)
+                sts3x_read_serial_dev(&dev, &serial);
+        }
+    }
+    sequential_usec = sensirion_sim_i2c_now_usec() - start;
+
+    start = sensirion_sim_i2c_now_usec();
+    ret = sts3x_discover(muxes, num_muxes, &table);
+    discover_usec = sensirion_sim_i2c_now_usec() - start;
+    CHECK_ZERO_TEXT(ret, "sts3x_discover");
+    CHECK_TRUE_TEXT(discover_usec < sequential_usec / 2,
+                    "sts3x_discover duration");
+    CHECK_TRUE_TEXT(sts3x_discovery_table_is_valid(&table),
+                    "sts3x_discovery_table_is_valid");
+
+    /* the sensor on the bus itself is not reported again for each channel */
+    CHECK_EQUAL_TEXT(4, table.count, "sts3x_discover count");
+    CHECK_EQUAL_TEXT(STS3X_ADDRESS_ALTERNATE, table.sensors[0].address,
+                     "sts3x_discover address");
+    CHECK_EQUAL_TEXT(STS3X_DISCOVERY_NO_MUX, table.sensors[0].mux_address,
+                     "sts3x_discover mux_address");
+    CHECK_EQUAL_TEXT(0x4B00, table.sensors[0].serial, "sts3x_discover serial");
+    for (i = 0; i < 3; ++i) {
+        CHECK_EQUAL_TEXT(STS3X_ADDRESS_DEFAULT, table.sensors[i + 1].address,
+                         "sts3x_discover address");
+        CHECK_EQUAL_TEXT(SIM_MUX_ADDRESS, table.sensors[i + 1].mux_address,
+                         "sts3x_discover mux_address");
+        CHECK_EQUAL_TEXT(expected_channels[i], table.sensors[i + 1].mux_channel,
+                         "sts3x_discover mux_channel");
+        CHECK_EQUAL_TEXT(0x4A00u + expected_channels[i],
+                         table.sensors[i + 1].serial, "sts3x_discover serial");
+    }
+    CHECK_ZERO_TEXT(sensirion_i2c_read(SIM_MUX_ADDRESS, &mask, 1),
+                    "read mux channels");
+    CHECK_ZERO_TEXT(mask, "mux channels disabled");
+
+    sts3x_init_discovered_dev(&dev, &mux_channel, &table.sensors[3]);
+    ret = sts3x_read_serial_dev(&dev, &serial);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_serial_dev");
+    CHECK_EQUAL_TEXT(0x4A07, serial, "sts3x_read_serial_dev");
+
+    /* warm restart with an intact table skips the scan */
+    cached = table;
+    start = sensirion_sim_i2c_now_usec();
+    ret = sts3x_discover_cached(muxes, num_muxes, &cached, &rescanned);
+    CHECK_ZERO_TEXT(ret, "sts3x_discover_cached");
+    CHECK_ZERO_TEXT(rescanned, "sts3x_discover_cached rescanned");
+    CHECK_TRUE_TEXT(sensirion_sim_i2c_now_usec() - start < discover_usec / 2,
+                    "sts3x_discover_cached duration");
+
+    /* a corrupted table is scanned anew */
+    cached.sensors[2].serial ^= 1;
+    CHECK_FALSE_TEXT(sts3x_discovery_table_is_valid(&cached),
+                     "sts3x_discovery_table_is_valid corrupted");
+    ret = sts3x_discover_cached(muxes, num_muxes, &cached, &rescanned);
+    CHECK_ZERO_TEXT(ret, "sts3x_discover_cached");
+    CHECK_EQUAL_TEXT(1, rescanned, "sts3x_discover_cached rescanned");
+    CHECK_EQUAL_TEXT(table.sensors[2].serial, cached.sensors[2].serial,
+                     "sts3x_discover_cached serial");
+
+    /* as is a table with missing sensors */
+    sensirion_sim_i2c_remove_devices();
+    CHECK_EQUAL_TEXT(STATUS_NACK, sts3x_discovery_verify(&cached),
+                     "sts3x_discovery_verify");
+    ret = sts3x_discover_cached(muxes, num_muxes, &cached, &rescanned);
+    CHECK_ZERO_TEXT(ret, "sts3x_discover_cached");
+    CHECK_EQUAL_TEXT(1, rescanned, "sts3x_discover_cached rescanned");
+    CHECK_ZERO_TEXT(cached.count, "sts3x_discover_cached count");
+
+    /* a missing multiplexer is reported, the others are still scanned */
+    sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_DEFAULT, 3, 0x4A03);
+    ret = sts3x_discover(muxes, 2, &table);
+    CHECK_EQUAL_TEXT(STATUS_NACK, ret, "sts3x_discover with a missing mux");
+    CHECK_EQUAL_TEXT(1, table.count, "sts3x_discover count");
+    CHECK_EQUAL_TEXT(0x4A03, table.sensors[0].serial, "sts3x_discover serial");
+    CHECK_TRUE_TEXT(sts3x_discovery_table_is_valid(&table),
+                    "sts3x_discovery_table_is_valid");
+}
+
+static uint8_t sim_heater_on(struct sts3x_dev* dev) {
+    uint16_t status;
+
+    CHECK_ZERO_TEXT(sts3x_read_status_dev(dev, &status), "sts3x_read_status");
+    return (status & STS3X_STATUS_HEATER_ON) != 0;
+}
+
+TEST (STS3xSimTestGroup, SelfTestRunsSensorsInParallel) {
+    static const struct sts3x_self_test_config config =
+        STS3X_SELF_TEST_CONFIG_DEFAULT;
+    struct sts3x_i2c_mux_channel channels[4];
+    struct sts3x_self_test tests[4];
+    struct sts3x_dev devs[4];
+    uint64_t start;
+    uint64_t duration;
+    int16_t device;
+    int16_t ret;
+    uint8_t i;
+
+    sensirion_sim_i2c_remove_devices();
+    for (i = 0; i < 4; ++i) {
+        device = sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_DEFAULT, i, i);
+        /* sensor 2 has a weak heater */
+        sensirion_sim_i2c_set_heater(device, i == 2 ? 300 : 3000, 1000000);
+
+        channels[i].mux_address = SIM_MUX_ADDRESS;
+        channels[i].channel = i;
+        sts3x_init_dev(&devs[i], STS3X_ADDRESS_DEFAULT);
+        devs[i].select_bus = sts3x_select_i2c_mux_channel;
+        devs[i].bus = &channels[i];
+        sts3x_self_test_init(&tests[i], &devs[i], &config);
+    }
+
+    start = sensirion_sim_i2c_now_usec();
+    ret = sts3x_self_test_run(tests, 4, sensirion_sim_i2c_clock_usec);
+    duration = sensirion_sim_i2c_now_usec() - start;
+    CHECK_EQUAL_TEXT(STATUS_SELF_TEST_FAILED, ret, "sts3x_self_test_run");
+    for (i = 0; i < 4; ++i) {
+        CHECK_EQUAL_TEXT(i == 2 ? STATUS_SELF_TEST_FAILED : STATUS_OK,
+                         tests[i].result, "sts3x_self_test_run result");
+        CHECK_FALSE_TEXT(sim_heater_on(&devs[i]), "heater off");
+    }
+
+    /* passing sensors stop once the increase is reached */
+    CHECK_TRUE_TEXT(tests[0].increase >= config.min_increase,
+                    "sts3x_self_test_run increase");
+    CHECK_TRUE_TEXT(tests[0].duration_usec < config.budget_usec / 4,
+                    "sts3x_self_test_run passed duration");
+    CHECK_TRUE_TEXT(tests[2].increase < config.min_increase,
+                    "sts3x_self_test_run failed increase");
+    /* plus the transactions with the other sensors */
+    CHECK_TRUE_TEXT(tests[2].duration_usec <= config.budget_usec + 5000,
+                    "sts3x_self_test_run failed duration");
+    /* the sensors were tested at the same time, not one after the other */
+    CHECK_TRUE_TEXT(duration <= config.budget_usec + 5000,
+                    "sts3x_self_test_run duration");
+}
+
+TEST (STS3xSimTestGroup, SelfTestTurnsHeaterOffOnFailure) {
+    static const struct sts3x_self_test_config config =
+        STS3X_SELF_TEST_CONFIG_DEFAULT;
+    struct sts3x_self_test test;
+    struct sts3x_dev dev;
+    uint32_t next_due_usec;
+    int16_t ret;
+
+    sts3x_init_dev(&dev, STS3X_ADDRESS_DEFAULT);
+    sts3x_self_test_init(&test, &dev, &config);
+
+    /* baseline measurement and heater on */
+    ret = sts3x_self_test_poll(&test, 1, sensirion_sim_i2c_clock_usec,
+                               &next_due_usec);
+    CHECK_EQUAL_TEXT(STATUS_IN_PROGRESS, ret, "sts3x_self_test_poll");
+    CHECK_EQUAL_TEXT(sensirion_sim_i2c_clock_usec() +
+                         sts3x_get_measurement_duration_usec_dev(&dev),
+                     next_due_usec, "sts3x_self_test_poll next_due_usec");
+    sensirion_sim_i2c_advance_usec(next_due_usec -
+                                   sensirion_sim_i2c_clock_usec());
+    ret = sts3x_self_test_poll(&test, 1, sensirion_sim_i2c_clock_usec,
+                               &next_due_usec);
+    CHECK_EQUAL_TEXT(STATUS_IN_PROGRESS, ret, "sts3x_self_test_poll");
+    CHECK_TRUE_TEXT(sim_heater_on(&dev), "heater on");
+
+    /* the heated measurement fails */
+    sensirion_sim_i2c_advance_usec(next_due_usec -
+                                   sensirion_sim_i2c_clock_usec());
+    ret = sts3x_self_test_poll(&test, 1, sensirion_sim_i2c_clock_usec,
+                               &next_due_usec);
+    CHECK_EQUAL_TEXT(STATUS_IN_PROGRESS, ret, "sts3x_self_test_poll");
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_CRC, 1);
+    sensirion_sim_i2c_advance_usec(next_due_usec -
+                                   sensirion_sim_i2c_clock_usec());
+    ret = sts3x_self_test_poll(&test, 1, sensirion_sim_i2c_clock_usec,
+                               &next_due_usec);
+    CHECK_EQUAL_TEXT(STATUS_CRC_FAIL, ret, "sts3x_self_test_poll");
+    CHECK_EQUAL_TEXT(STATUS_CRC_FAIL, test.result, "sts3x_self_test result");
+    CHECK_FALSE_TEXT(sim_heater_on(&dev), "heater off");
+
+    /* a sensor in periodic mode is not touched */
+    ret = sts3x_start_periodic_measurement_dev(&dev,
+                                               STS3X_MEASUREMENT_RATE_1_MPS);
+    CHECK_ZERO_TEXT(ret, "sts3x_start_periodic_measurement_dev");
+    sts3x_self_test_init(&test, &dev, &config);
+    ret = sts3x_self_test_run(&test, 1, sensirion_sim_i2c_clock_usec);
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA, ret, "sts3x_self_test_run periodic");
+    ret = sts3x_stop_periodic_measurement_dev(&dev);
+    CHECK_ZERO_TEXT(ret, "sts3x_stop_periodic_measurement_dev");
+}
+
+TEST (STS3xSimTestGroup, NonBlockingMeasurement) {
+    int32_t temperature;
+    uint32_t ready_at_usec;
+    uint32_t first_ready_at_usec;
+    int16_t ret;
+
+    ret = sts3x_measure_poll(sensirion_sim_i2c_clock_usec, &temperature,
+                             &first_ready_at_usec);
+    CHECK_EQUAL_TEXT(STATUS_IN_PROGRESS, ret, "sts3x_measure_poll start");
+
+    ret = sts3x_measure_poll(sensirion_sim_i2c_clock_usec, &temperature,
+                             &ready_at_usec);
+    CHECK_EQUAL_TEXT(STATUS_IN_PROGRESS, ret, "sts3x_measure_poll pending");
+    CHECK_EQUAL_TEXT(first_ready_at_usec, ready_at_usec,
+                     "sts3x_measure_poll ready time");
+
+    sensirion_sim_i2c_advance_usec(ready_at_usec -
+                                   sensirion_sim_i2c_clock_usec());
+    ret = sts3x_measure_poll(sensirion_sim_i2c_clock_usec, &temperature,
+                             &ready_at_usec);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_poll read out");
+    CHECK_TEMPERATURE(25000, temperature, "sts3x_measure_poll");
+}
+
+/* standard conversion shifted by the offset passed as calibration */
+static int32_t offset_conversion(uint16_t ticks, const void* calibration) {
+    return sts3x_ticks_to_milli_celsius(ticks) +
+           *(const int32_t*)calibration;
+}
+
+TEST (STS3xSimTestGroup, ConversionAppliesToAllReadouts) {
+    static const int32_t offset = -1500;
+    int32_t temperature;
+    uint32_t timestamp_usec;
+    uint32_t ready_at_usec;
+    uint16_t ticks;
+    int16_t ret;
+
+    sensirion_sim_i2c_set_temperature(0, 21500);
+    sts3x_set_conversion(offset_conversion, &offset);
+
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read");
+    CHECK_TEMPERATURE(20000, temperature, "sts3x_measure_blocking_read");
+
+    ret = sts3x_measure();
+    CHECK_ZERO_TEXT(ret, "sts3x_measure");
+    sensirion_sleep_usec(sts3x_get_measurement_duration_usec());
+    ret = sts3x_read_ticks(&ticks);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_ticks");
+    CHECK_TEMPERATURE(21500, sts3x_ticks_to_milli_celsius(ticks),
+                      "raw signals are not converted");
+
+    ret = sts3x_start_periodic_measurement(STS3X_MEASUREMENT_RATE_10_MPS);
+    CHECK_ZERO_TEXT(ret, "sts3x_start_periodic_measurement");
+    do {
+        ret = sts3x_fetch_timestamped(sensirion_sim_i2c_clock_usec,
+                                      &temperature, &timestamp_usec,
+                                      &ready_at_usec);
+        if (ret == STATUS_IN_PROGRESS)
+            sensirion_sim_i2c_advance_usec(ready_at_usec -
+                                           sensirion_sim_i2c_clock_usec());
+    } while (ret == STATUS_IN_PROGRESS);
+    CHECK_ZERO_TEXT(ret, "sts3x_fetch_timestamped");
+    CHECK_TEMPERATURE(20000, temperature, "sts3x_fetch_timestamped");
+    ret = sts3x_stop_periodic_measurement();
+    CHECK_ZERO_TEXT(ret, "sts3x_stop_periodic_measurement");
+
+    sts3x_set_conversion(NULL, NULL);
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read");
+    CHECK_TEMPERATURE(21500, temperature, "standard conversion");
+}
+
+TEST (STS3xSimTestGroup, RingBufferRecordsMeasurement) {
+    struct sts3x_ring_buffer_entry entries[4];
+    struct sts3x_ring_buffer buffer;
+    struct sts3x_sample samples[4];
+    struct sts3x_dev dev;
+    uint16_t count;
+    int16_t ret;
+
+    sts3x_ring_buffer_init(&buffer, entries, 4);
+    sts3x_ring_buffer_push(&buffer, 0x6000, 1000);
+
+    sensirion_sim_i2c_set_temperature(0, 21500);
+    sts3x_init_dev(&dev, STS3X_ADDRESS_DEFAULT);
+    ret = sts3x_measure_dev(&dev);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_dev");
+    sensirion_sleep_usec(sts3x_get_measurement_duration_usec_dev(&dev));
+    ret = sts3x_ring_buffer_record_dev(&buffer, &dev, 1200);
+    CHECK_ZERO_TEXT(ret, "sts3x_ring_buffer_record_dev");
+
+    /* no sample is added on errors */
+    ret = sts3x_ring_buffer_record_dev(&buffer, &dev, 1400);
+    CHECK_TRUE_TEXT(ret != 0, "sts3x_ring_buffer_record_dev without result");
+
+    count = sts3x_ring_buffer_drain(&buffer, samples, 4);
+    CHECK_EQUAL_TEXT(2, count, "sts3x_ring_buffer_drain");
+    CHECK_EQUAL_TEXT(1200, samples[1].timestamp, "recorded timestamp");
+    CHECK_TEMPERATURE(21500, samples[1].temperature, "recorded temperature");
+}
+
+/* length of the window sill trace */
+#define TRACE_DURATION_USEC 3600000000u
+
+TEST (STS3xSimTestGroup, SchedulerAdaptsToRecordedTrace) {
+    /* 0.1 degree Celsius, changes are noticed within 10 seconds */
+    static const struct sts3x_scheduler_config config = {
+        1000000, 10000000, 100, 0, 0, 1000};
+    struct trace_replay_result fixed;
+    struct trace_replay_result adaptive;
+    struct sts3x_scheduler scheduler;
+    struct sts3x_dev dev;
+
+    sts3x_init_dev(&dev, STS3X_ADDRESS_DEFAULT);
+    replay_recorded_trace(&window_sill_trace, &dev, NULL, 0, &fixed);
+    CHECK_EQUAL_TEXT(3600, fixed.wakeups, "fixed loop wakeups");
+    CHECK_ZERO_TEXT(fixed.failures, "fixed loop failures");
+
+    sts3x_scheduler_init(&scheduler, &dev, &config);
+    replay_recorded_trace(&window_sill_trace, &dev, &scheduler, 0, &adaptive);
+    CHECK_ZERO_TEXT(adaptive.failures, "failures");
+    CHECK_EQUAL_TEXT(adaptive.wakeups, scheduler.samples, "samples");
+
+    /* stable periods need a fraction of the wakeups and bus time */
+    CHECK_TRUE_TEXT(adaptive.wakeups * 4 < fixed.wakeups, "wakeups");
+    CHECK_TRUE_TEXT(adaptive.bus_usec * 4 < fixed.bus_usec, "bus time");
+    /* a change is followed after at most 10 seconds at ~65 mdegC/s */
+    CHECK_TRUE_TEXT(adaptive.max_error < 1000, "tracking error");
+    CHECK_TRUE_TEXT(fixed.max_error < 100, "fixed loop tracking error");
+}
+
+TEST (STS3xSimTestGroup, SchedulerKeepsEnergyBudget) {
+    static const struct sts3x_scheduler_config config =
+        STS3X_SCHEDULER_CONFIG_DEFAULT;
+    struct trace_replay_result adaptive;
+    struct sts3x_scheduler scheduler;
+    struct sts3x_dev dev;
+
+    sts3x_init_dev(&dev, STS3X_ADDRESS_DEFAULT);
+    sts3x_scheduler_init(&scheduler, &dev, &config);
+    replay_recorded_trace(&window_sill_trace, &dev, &scheduler, 0, &adaptive);
+    CHECK_ZERO_TEXT(adaptive.failures, "failures");
+
+    CHECK_TRUE_TEXT(scheduler.active_usec <=
+                        (uint64_t)config.budget_ppm * TRACE_DURATION_USEC /
+                                1000000 +
+                            config.burst_usec,
+                    "active time within the budget");
+#ifdef STS3X_FIXED_REPEATABILITY
+    CHECK_EQUAL_TEXT(STS3X_FIXED_REPEATABILITY, adaptive.max_repeatability,
+                     "fixed repeatability");
+#else
+    CHECK_EQUAL_TEXT(2, adaptive.max_repeatability,
+                     "low repeatability once the credit is used up");
+#endif /* STS3X_FIXED_REPEATABILITY */
+    CHECK_TRUE_TEXT(adaptive.max_error < 5000, "tracking error");
+}
+
+TEST (STS3xSimTestGroup, SchedulerWaitsForCreditUpToLongestInterval) {
+    /* far less than one measurement per minute */
+    static const struct sts3x_scheduler_config config = {
+        1000000, 60000000, 100, 1, 0, 1000};
+    struct sts3x_scheduler scheduler;
+    struct sts3x_dev dev;
+    int32_t temperature;
+    uint32_t next_due_usec;
+    uint8_t repeatability;
+    uint8_t i;
+    int16_t ret;
+
+    sensirion_sim_i2c_set_temperature(0, 21000);
+    sts3x_init_dev(&dev, STS3X_ADDRESS_DEFAULT);
+    sts3x_set_repeatability_dev(&dev, 1);
+    repeatability = dev.repeatability;
+    sts3x_scheduler_init(&scheduler, &dev, &config);
+    CHECK_EQUAL_TEXT(repeatability, dev.repeatability,
+                     "sts3x_scheduler_init keeps the repeatability");
+
+    for (i = 0; i < 5; ++i) {
+        ret = sts3x_scheduler_poll(&scheduler, sensirion_sim_i2c_clock_usec,
+                                   &temperature, &next_due_usec);
+        CHECK_ZERO_TEXT(ret, "sts3x_scheduler_poll");
+        CHECK_EQUAL_TEXT(config.max_interval_usec, scheduler.interval_usec,
+                         "interval extended up to the longest interval");
+        CHECK_EQUAL_TEXT(config.max_interval_usec,
+                         next_due_usec - scheduler.last_at_usec,
+                         "next measurement due");
+#ifdef STS3X_FIXED_REPEATABILITY
+        CHECK_EQUAL_TEXT(STS3X_FIXED_REPEATABILITY, scheduler.repeatability,
+                         "fixed repeatability");
+#else
+        CHECK_EQUAL_TEXT(2, scheduler.repeatability,
+                         "low repeatability without credit");
+#endif /* STS3X_FIXED_REPEATABILITY */
+        CHECK_EQUAL_TEXT(repeatability, dev.repeatability,
+                         "sts3x_scheduler_poll keeps the repeatability");
+        sensirion_sim_i2c_advance_usec(next_due_usec -
+                                       sensirion_sim_i2c_clock_usec());
+    }
+    CHECK_EQUAL_TEXT(5, scheduler.samples, "samples");
+}
+
+TEST (STS3xSimTestGroup, StatusRegister) {
+    struct sensirion_sim_i2c_stats stats;
+    struct sts3x_status decoded;
+    uint16_t status;
+    int16_t ret;
+
+    ret = sts3x_read_status(&status);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_status");
+    sts3x_decode_status(status, &decoded);
+    CHECK_TRUE_TEXT(decoded.reset_detected, "reset detected after power up");
+    CHECK_FALSE_TEXT(decoded.heater_on, "heater off after power up");
+
+    ret = sts3x_clear_status();
+    CHECK_ZERO_TEXT(ret, "sts3x_clear_status");
+    ret = sts3x_heater_on();
+    CHECK_ZERO_TEXT(ret, "sts3x_heater_on");
+
+    /* the cache follows the commands of the driver without bus access */
+    sensirion_sim_i2c_reset_stats();
+    ret = sts3x_get_cached_status(&status);
+    CHECK_ZERO_TEXT(ret, "sts3x_get_cached_status");
+    CHECK_EQUAL_TEXT(STS3X_STATUS_HEATER_ON, status, "cached status");
+    sensirion_sim_i2c_get_stats(&stats);
+    CHECK_ZERO_TEXT(stats.transactions, "sts3x_get_cached_status transactions");
+
+    ret = sts3x_probe();
+    CHECK_ZERO_TEXT(ret, "sts3x_probe");
+    ret = sts3x_get_cached_status(&status);
+    CHECK_ZERO_TEXT(ret, "sts3x_get_cached_status");
+    CHECK_EQUAL_TEXT(STS3X_STATUS_HEATER_ON, status, "status after probe");
+
+    ret = sts3x_heater_off();
+    CHECK_ZERO_TEXT(ret, "sts3x_heater_off");
+    ret = sts3x_read_status(&status);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_status");
+    CHECK_ZERO_TEXT(status, "status after heater off");
+}
+
+TEST (STS3xSimTestGroup, AlertMode) {
+    struct sts3x_alert_limits limits = {30000, 28000, 5000, 0};
+    struct sts3x_alert_limits read_limits;
+    struct sts3x_status decoded;
+    uint16_t status;
+    int16_t ret;
+
+    ret = sts3x_set_alert_limits(&limits);
+    CHECK_ZERO_TEXT(ret, "sts3x_set_alert_limits");
+    ret = sts3x_get_alert_limits(&read_limits);
+    CHECK_ZERO_TEXT(ret, "sts3x_get_alert_limits");
+    /* the limits are stored with 9 bit resolution */
+    CHECK_TRUE_TEXT(read_limits.high_set >= limits.high_set - 200 &&
+                        read_limits.high_set <= limits.high_set + 200,
+                    "high_set");
+    CHECK_TRUE_TEXT(read_limits.high_clear >= limits.high_clear - 200 &&
+                        read_limits.high_clear <= limits.high_clear + 200,
+                    "high_clear");
+    CHECK_TRUE_TEXT(read_limits.low_clear >= limits.low_clear - 200 &&
+                        read_limits.low_clear <= limits.low_clear + 200,
+                    "low_clear");
+    CHECK_TRUE_TEXT(read_limits.low_set >= limits.low_set - 200 &&
+                        read_limits.low_set <= limits.low_set + 200,
+                    "low_set");
+
+    read_limits.low_set = read_limits.high_set;
+    ret = sts3x_set_alert_limits(&read_limits);
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA, ret, "limits out of order");
+
+    ret = sts3x_start_alert_mode(STS3X_MEASUREMENT_RATE_10_MPS, &limits);
+    CHECK_ZERO_TEXT(ret, "sts3x_start_alert_mode");
+    sensirion_sleep_usec(500000);
+    CHECK_FALSE_TEXT(sensirion_sim_i2c_get_alert(0), "alert within limits");
+
+    sensirion_sim_i2c_set_temperature(0, 35000);
+    sensirion_sleep_usec(200000);
+    CHECK_TRUE_TEXT(sensirion_sim_i2c_get_alert(0), "alert above high_set");
+    ret = sts3x_read_status(&status);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_status");
+    sts3x_decode_status(status, &decoded);
+    CHECK_TRUE_TEXT(decoded.alert_pending, "alert_pending");
+    CHECK_TRUE_TEXT(decoded.temperature_alert, "temperature_alert");
+
+    sensirion_sim_i2c_set_temperature(0, 29000);
+    sensirion_sleep_usec(200000);
+    CHECK_TRUE_TEXT(sensirion_sim_i2c_get_alert(0), "alert above high_clear");
+    sensirion_sim_i2c_set_temperature(0, 25000);
+    sensirion_sleep_usec(200000);
+    CHECK_FALSE_TEXT(sensirion_sim_i2c_get_alert(0), "alert below high_clear");
+
+    sensirion_sim_i2c_set_temperature(0, -1000);
+    sensirion_sleep_usec(200000);
+    CHECK_TRUE_TEXT(sensirion_sim_i2c_get_alert(0), "alert below low_set");
+
+    ret = sts3x_stop_periodic_measurement();
+    CHECK_ZERO_TEXT(ret, "sts3x_stop_periodic_measurement");
+}
+
+static int16_t sim_bus_clear(void* bus) {
+    (void)bus;
+    sensirion_sim_i2c_bus_clear();
+    return 0;
+}
+
+TEST (STS3xSimTestGroup, RetryPolicy) {
+    static const struct sts3x_retry_policy policy = {3, 2, 500, 4000,
+                                                     sim_bus_clear};
+    struct sensirion_sim_i2c_stats stats;
+    struct sts3x_dev dev;
+    int32_t temperature;
+    uint32_t serial;
+    uint16_t status;
+    int16_t ret;
+
+    sts3x_set_retry_policy(&policy);
+
+    /* only the read out is repeated, not the measurement */
+    sensirion_sim_i2c_reset_stats();
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_NACK, 2);
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read with NACKs");
+    CHECK_TEMPERATURE(25000, temperature, "sts3x_measure_blocking_read");
+    sensirion_sim_i2c_get_stats(&stats);
+    CHECK_EQUAL_TEXT(STS3X_MEASUREMENT_DURATION_USEC + 500 + 1000,
+                     stats.slept_usec, "sts3x_measure_blocking_read sleep");
+
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_CRC, 1);
+    ret = sts3x_read_serial(&serial);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_serial with CRC error");
+    CHECK_EQUAL_TEXT(0x12345678, serial, "sts3x_read_serial");
+
+    /* a measurement result with a wrong CRC is gone */
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_CRC, 1);
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_EQUAL_TEXT(STATUS_CRC_FAIL, ret, "sts3x_measure_blocking_read");
+    ret = sts3x_probe();
+    CHECK_ZERO_TEXT(ret, "sts3x_probe");
+
+    /* the bus is recovered after two failures in a row */
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_STUCK_BUS, 0);
+    ret = sts3x_probe();
+    CHECK_EQUAL_TEXT(STATUS_NACK, ret, "sts3x_probe with stuck bus");
+    ret = sts3x_probe();
+    CHECK_EQUAL_TEXT(STATUS_BUS_RESET, ret, "sts3x_probe with stuck bus");
+    ret = sts3x_get_cached_status(&status);
+    CHECK_ZERO_TEXT(ret, "sts3x_get_cached_status after recovery");
+    CHECK_EQUAL_TEXT(STS3X_STATUS_ALERT_PENDING | STS3X_STATUS_RESET_DETECTED,
+                     status, "cached status after recovery");
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read after recovery");
+
+    /* a status that was never read out stays unknown */
+    sts3x_init_dev(&dev, STS3X_ADDRESS_DEFAULT);
+    sts3x_set_retry_policy_dev(&dev, &policy);
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_STUCK_BUS, 0);
+    ret = sts3x_measure_blocking_read_dev(&dev, &temperature);
+    CHECK_EQUAL_TEXT(STATUS_NACK, ret, "new instance with stuck bus");
+    ret = sts3x_measure_blocking_read_dev(&dev, &temperature);
+    CHECK_EQUAL_TEXT(STATUS_BUS_RESET, ret, "recovery of a new instance");
+    ret = sts3x_get_cached_status_dev(&dev, &status);
+    CHECK_EQUAL_TEXT(STATUS_ERR_BAD_DATA, ret, "sts3x_get_cached_status_dev");
+
+    sts3x_set_retry_policy(NULL);
+}
+
+TEST (STS3xSimTestGroup, RecoveryOnlyResetsFailingSensor) {
+    static const struct sts3x_retry_policy policy = {0, 1, 0, 0,
+                                                     sim_bus_clear};
+    struct sts3x_dev other;
+    int32_t temperature;
+    uint16_t status;
+    int16_t ret;
+
+    sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_ALTERNATE, 0, 0x1234);
+    sts3x_init_dev(&other, STS3X_ADDRESS_ALTERNATE);
+    ret = sts3x_clear_status_dev(&other);
+    CHECK_ZERO_TEXT(ret, "sts3x_clear_status_dev");
+    ret = sts3x_start_periodic_measurement_dev(&other,
+                                               STS3X_MEASUREMENT_RATE_10_MPS);
+    CHECK_ZERO_TEXT(ret, "sts3x_start_periodic_measurement_dev");
+
+    sts3x_set_retry_policy(&policy);
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_STUCK_BUS, 0);
+    ret = sts3x_probe();
+    CHECK_EQUAL_TEXT(STATUS_BUS_RESET, ret, "sts3x_probe with stuck bus");
+    ret = sts3x_read_status(&status);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_status");
+    CHECK_TRUE_TEXT(status & STS3X_STATUS_RESET_DETECTED, "sensor is reset");
+
+    /* the other sensor keeps measuring */
+    sensirion_sleep_usec(100000);
+    ret = sts3x_fetch_data_dev(&other, &temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_fetch_data_dev of the other sensor");
+    ret = sts3x_stop_periodic_measurement_dev(&other);
+    CHECK_ZERO_TEXT(ret, "sts3x_stop_periodic_measurement_dev");
+    ret = sts3x_read_status_dev(&other, &status);
+    CHECK_ZERO_TEXT(ret, "sts3x_read_status_dev");
+    CHECK_FALSE_TEXT(status & STS3X_STATUS_RESET_DETECTED,
+                     "other sensor is not reset");
+
+    sts3x_set_retry_policy(NULL);
+}
+
+struct counting_lock {
+    uint16_t locked;
+    uint16_t unlocked;
+};
+
+static void counting_lock_acquire(void* context) {
+    ((struct counting_lock*)context)->locked++;
+}
+
+static void counting_lock_release(void* context) {
+    ((struct counting_lock*)context)->unlocked++;
+}
+
+TEST (STS3xSimTestGroup, BusLockIsHeldAcrossSequences) {
+    struct counting_lock counts = {0, 0};
+    const struct sts3x_bus_lock lock = {counting_lock_acquire,
+                                        counting_lock_release, &counts};
+    struct sts3x_alert_limits limits = {60000, 58000, -8000, -10000};
+    struct sts3x_dev devs[2];
+    int32_t temperatures[2];
+    int16_t status[2];
+    int32_t temperature;
+    int16_t ret;
+    uint8_t i;
+
+    sts3x_set_bus_lock(&lock);
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read");
+    CHECK_EQUAL_TEXT(1, counts.locked, "locked once per blocking read");
+    CHECK_EQUAL_TEXT(1, counts.unlocked, "unlocked after the blocking read");
+
+    ret = sts3x_start_alert_mode(STS3X_MEASUREMENT_RATE_1_MPS, &limits);
+    CHECK_ZERO_TEXT(ret, "sts3x_start_alert_mode");
+    ret = sts3x_stop_periodic_measurement();
+    CHECK_ZERO_TEXT(ret, "sts3x_stop_periodic_measurement");
+    CHECK_EQUAL_TEXT(3, counts.locked, "locked once per function");
+    CHECK_EQUAL_TEXT(3, counts.unlocked, "unlocked once per function");
+    sts3x_set_bus_lock(NULL);
+
+    /* a batch locks each bus once */
+    sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_ALTERNATE, 0, 2);
+    sts3x_init_dev(&devs[0], STS3X_ADDRESS_DEFAULT);
+    sts3x_init_dev(&devs[1], STS3X_ADDRESS_ALTERNATE);
+    for (i = 0; i < 2; ++i)
+        sts3x_set_bus_lock_dev(&devs[i], &lock);
+    ret = sts3x_measure_blocking_read_batch(devs, 2, temperatures, status);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read_batch");
+    CHECK_EQUAL_TEXT(4, counts.locked, "locked once per batch");
+    CHECK_EQUAL_TEXT(4, counts.unlocked, "unlocked once per batch");
+}
+
+#define THREAD_COUNT 4
+#define THREAD_MEASUREMENTS 50
+
+struct measure_thread {
+    pthread_t thread;
+    struct sts3x_dev dev;
+    struct sts3x_i2c_mux_channel channel;
+    int32_t expected;
+    uint16_t errors;
+};
+
+static void* measure_thread_run(void* context) {
+    struct measure_thread* t = (struct measure_thread*)context;
+    int32_t temperature;
+    uint16_t i;
+
+    for (i = 0; i < THREAD_MEASUREMENTS; ++i) {
+        if (sts3x_measure_blocking_read_dev(&t->dev, &temperature) ||
+            temperature < t->expected - 3 || temperature > t->expected + 3)
+            t->errors++;
+        /* let the threads interleave even on a single core */
+        sched_yield();
+    }
+    return NULL;
+}
+
+TEST (STS3xSimTestGroup, ThreadsShareBusWithTicketLock) {
+    struct measure_thread threads[THREAD_COUNT];
+    struct sts_ticket_lock ticket_lock;
+    const struct sts3x_bus_lock lock = {sts_ticket_lock_acquire,
+                                        sts_ticket_lock_release, &ticket_lock};
+    int16_t device;
+    uint8_t i;
+
+    CHECK_ZERO_TEXT(sts_ticket_lock_init(&ticket_lock), "sts_ticket_lock_init");
+    sensirion_sim_i2c_remove_devices();
+    for (i = 0; i < THREAD_COUNT; ++i) {
+        struct measure_thread* t = &threads[i];
+
+        /* each thread uses its own sensor and repeatability on one bus */
+        device = sensirion_sim_i2c_add_sts3x(STS3X_ADDRESS_DEFAULT, i, i);
+        t->expected = 20000 + i * 1000;
+        sensirion_sim_i2c_set_temperature(device, t->expected);
+        t->channel.mux_address = SIM_MUX_ADDRESS;
+        t->channel.channel = i;
+        sts3x_init_dev(&t->dev, STS3X_ADDRESS_DEFAULT);
+        sts3x_set_repeatability_dev(&t->dev, (uint8_t)(i % 3));
+        t->dev.select_bus = sts3x_select_i2c_mux_channel;
+        t->dev.bus = &t->channel;
+        sts3x_set_bus_lock_dev(&t->dev, &lock);
+        t->errors = 0;
+    }
+
+    for (i = 0; i < THREAD_COUNT; ++i)
+        pthread_create(&threads[i].thread, NULL, measure_thread_run,
+                       &threads[i]);
+    for (i = 0; i < THREAD_COUNT; ++i) {
+        pthread_join(threads[i].thread, NULL);
+        CHECK_ZERO_TEXT(threads[i].errors, "measurements of a thread");
+    }
+    sts_ticket_lock_destroy(&ticket_lock);
+}
+
+/* a bus of a HAL which keeps the selected bus per thread */
+struct hal_bus {
+    pthread_mutex_t mutex;
+    pthread_t owner;
+    uint8_t owned;
+};
+
+static __thread struct hal_bus* selected_hal_bus;
+static pthread_mutex_t hal_call_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t hal_call_violations;
+
+static void hal_bus_lock(void* context) {
+    struct hal_bus* bus = (struct hal_bus*)context;
+
+    pthread_mutex_lock(&bus->mutex);
+    bus->owner = pthread_self();
+    bus->owned = 1;
+}
+
+static void hal_bus_unlock(void* context) {
+    struct hal_bus* bus = (struct hal_bus*)context;
+
+    bus->owned = 0;
+    pthread_mutex_unlock(&bus->mutex);
+}
+
+static int16_t hal_bus_select(void* bus) {
+    selected_hal_bus = (struct hal_bus*)bus;
+    return 0;
+}
+
+/* each HAL call must happen on the selected bus with its lock held */
+static void check_hal_call(uint8_t enter, void* context) {
+    struct hal_bus* bus = selected_hal_bus;
+
+    (void)context;
+    if (!enter) {
+        pthread_mutex_unlock(&hal_call_mutex);
+        return;
+    }
+    /* the simulation itself is not thread-safe */
+    pthread_mutex_lock(&hal_call_mutex);
+    if (!bus || !bus->owned || !pthread_equal(bus->owner, pthread_self()))
+        hal_call_violations++;
+}
+
+TEST (STS3xSimTestGroup, ThreadsUseOneLockPerBus) {
+    static const uint8_t addresses[] = {STS3X_ADDRESS_DEFAULT,
+                                        STS3X_ADDRESS_ALTERNATE};
+    struct measure_thread threads[2];
+    struct hal_bus buses[2];
+    struct sts3x_bus_lock locks[2];
+    int16_t device;
+    uint8_t i;
+
+    sensirion_sim_i2c_remove_devices();
+    hal_call_violations = 0;
+    for (i = 0; i < 2; ++i) {
+        struct measure_thread* t = &threads[i];
+
+        /* two sensors on two buses, each bus with its own lock */
+        pthread_mutex_init(&buses[i].mutex, NULL);
+        buses[i].owned = 0;
+        locks[i].lock = hal_bus_lock;
+        locks[i].unlock = hal_bus_unlock;
+        locks[i].context = &buses[i];
+        device = sensirion_sim_i2c_add_sts3x(addresses[i],
+                                             SENSIRION_SIM_I2C_NO_MUX, i);
+        t->expected = 20000 + i * 1000;
+        sensirion_sim_i2c_set_temperature(device, t->expected);
+        sts3x_init_dev(&t->dev, addresses[i]);
+        t->dev.select_bus = hal_bus_select;
+        t->dev.bus = &buses[i];
+        sts3x_set_bus_lock_dev(&t->dev, &locks[i]);
+        t->errors = 0;
+    }
+    sensirion_sim_i2c_set_call_hook(check_hal_call, NULL);
+
+    for (i = 0; i < 2; ++i)
+        pthread_create(&threads[i].thread, NULL, measure_thread_run,
+                       &threads[i]);
+    for (i = 0; i < 2; ++i) {
+        pthread_join(threads[i].thread, NULL);
+        CHECK_ZERO_TEXT(threads[i].errors, "measurements of a thread");
+    }
+    sensirion_sim_i2c_set_call_hook(NULL, NULL);
+    CHECK_ZERO_TEXT(hal_call_violations, "HAL calls outside of the bus lock");
+    for (i = 0; i < 2; ++i)
+        pthread_mutex_destroy(&buses[i].mutex);
+}
+
+#ifdef STS3X_ENABLE_INSTRUMENTATION
+static uint32_t hook_calls;
+static uint32_t hook_failures;
+
+static void count_transactions(const struct sts3x_dev* dev, uint8_t direction,
+                               uint16_t num_bytes, int16_t result,
+                               uint32_t duration_usec) {
+    (void)dev;
+    (void)direction;
+    (void)num_bytes;
+    (void)duration_usec;
+    hook_calls++;
+    if (result)
+        hook_failures++;
+}
+
+TEST (STS3xSimTestGroup, Instrumentation) {
+    struct sts3x_stats stats;
+    int32_t temperature;
+    int16_t ret;
+
+    hook_calls = 0;
+    hook_failures = 0;
+    sts3x_reset_stats();
+    sts3x_set_instrumentation(sensirion_sim_i2c_clock_usec,
+                              count_transactions);
+
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_blocking_read");
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_CRC, 1);
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_EQUAL_TEXT(STATUS_CRC_FAIL, ret, "sts3x_measure_blocking_read");
+    sensirion_sim_i2c_inject_fault(SENSIRION_SIM_I2C_FAULT_NACK, 1);
+    ret = sts3x_measure_blocking_read(&temperature);
+    CHECK_TRUE_TEXT(ret != 0, "sts3x_measure_blocking_read with NACK");
+    /* the polling read out is not acknowledged until the result is ready */
+    ret = sts3x_measure_polling_read(&temperature);
+    CHECK_ZERO_TEXT(ret, "sts3x_measure_polling_read");
+
+    sts3x_get_stats(&stats);
+    CHECK_EQUAL_TEXT(stats.transactions, hook_calls, "transaction hook calls");
+    CHECK_EQUAL_TEXT(stats.nacks + stats.crc_errors, hook_failures,
+                     "transaction hook failures");
+    CHECK_EQUAL_TEXT(1, stats.crc_errors, "crc_errors");
+    CHECK_EQUAL_TEXT(stats.retries + 1, stats.nacks, "nacks");
+    CHECK_TRUE_TEXT(stats.latency_min_usec > 0, "latency_min_usec");
+    CHECK_TRUE_TEXT(stats.latency_min_usec <= stats.latency_mean_usec &&
+                        stats.latency_mean_usec <= stats.latency_max_usec,
+                    "latency_mean_usec");
+
+    sts3x_set_instrumentation(NULL, NULL);
+    sts3x_reset_stats();
+    sts3x_get_stats(&stats);
+    CHECK_ZERO_TEXT(stats.transactions, "transactions after reset");
+    CHECK_ZERO_TEXT(stats.latency_min_usec, "latency_min_usec after reset");
+}
+#endif /* STS3X_ENABLE_INSTRUMENTATION */
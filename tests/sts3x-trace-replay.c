@@ -0,0 +1,97 @@
+/*
+ * Replay of recorded temperature traces against the simulated bus, see
+ * sts3x-trace-replay.h.
+ */
+
+#include "sts3x-trace-replay.h"
+#include "sensirion_common.h"
+
+#define FIXED_INTERVAL_USEC 1000000
+/* the reading is compared with the trace once per second */
+#define CHECK_INTERVAL_USEC 1000000
+
+static const struct sensirion_sim_i2c_trace_point window_sill_points[] = {
+    {0, 21000},       {1800000, 21200}, {1920000, 29000},
+    {2400000, 30000}, {2460000, 26000}, {3600000, 25500},
+};
+
+static const struct sensirion_sim_i2c_trace_point cold_room_points[] = {
+    {0, 4000},        {1200000, 4100}, {1260000, 9000}, {1500000, 4300},
+    {2400000, 4000},  {2460000, 9500}, {2700000, 4200}, {3600000, 4000},
+};
+
+const struct recorded_trace window_sill_trace = {
+    "window_sill", window_sill_points,
+    sizeof(window_sill_points) / sizeof(window_sill_points[0])};
+
+const struct recorded_trace cold_room_trace = {
+    "cold_room", cold_room_points,
+    sizeof(cold_room_points) / sizeof(cold_room_points[0])};
+
+void replay_recorded_trace(const struct recorded_trace* recorded,
+                           struct sts3x_dev* dev,
+                           struct sts3x_scheduler* scheduler,
+                           uint32_t overhead_usec,
+                           struct trace_replay_result* result) {
+    struct sensirion_sim_i2c_trace trace;
+    struct sensirion_sim_i2c_stats stats;
+    const uint64_t start = sensirion_sim_i2c_now_usec();
+    const uint64_t duration_usec =
+        (uint64_t)recorded->points[recorded->count - 1].time_msec * 1000;
+    uint64_t checked_at = start;
+    uint64_t due_at;
+    uint64_t now;
+    uint32_t next_due_usec;
+    int32_t temperature;
+    int32_t reading = 0;
+    int32_t error;
+    int16_t ret;
+
+    trace.points = recorded->points;
+    trace.count = recorded->count;
+    trace.start_usec = start;
+    sensirion_sim_i2c_set_temperature_fn(0, sensirion_sim_i2c_trace_temperature,
+                                         &trace);
+    sensirion_sim_i2c_reset_stats();
+    result->wakeups = 0;
+    result->failures = 0;
+    result->active_usec = 0;
+    result->max_error = 0;
+    result->max_repeatability = 0;
+
+    while ((now = sensirion_sim_i2c_now_usec()) - start < duration_usec) {
+        result->wakeups++;
+        if (scheduler) {
+            ret = sts3x_scheduler_poll(scheduler, sensirion_sim_i2c_clock_usec,
+                                       &temperature, &next_due_usec);
+            if (scheduler->repeatability > result->max_repeatability)
+                result->max_repeatability = scheduler->repeatability;
+        } else {
+            result->active_usec +=
+                sts3x_get_measurement_duration_usec_dev(dev) + overhead_usec;
+            ret = sts3x_measure_blocking_read_dev(dev, &temperature);
+            next_due_usec = (uint32_t)now + FIXED_INTERVAL_USEC;
+        }
+        if (ret == STATUS_OK)
+            reading = temperature;
+        else
+            result->failures++;
+
+        now = sensirion_sim_i2c_now_usec();
+        due_at = now + (uint32_t)(next_due_usec - (uint32_t)now);
+        for (; checked_at < due_at; checked_at += CHECK_INTERVAL_USEC) {
+            error = sensirion_sim_i2c_trace_temperature(checked_at, &trace) -
+                    reading;
+            if (error < 0)
+                error = -error;
+            if (error > result->max_error)
+                result->max_error = error;
+        }
+        sensirion_sleep_usec((uint32_t)(due_at - now));
+    }
+
+    sensirion_sim_i2c_get_stats(&stats);
+    result->bus_usec = stats.bus_usec;
+    if (scheduler)
+        result->active_usec = scheduler->active_usec;
+}
@@ -0,0 +1,59 @@
+/*
+ * Replay of recorded temperature traces against the simulated bus, shared by
+ * the simulation tests and the benchmark.
+ */
+
+#ifndef STS3X_TRACE_REPLAY_H
+#define STS3X_TRACE_REPLAY_H
+
+#include "sensirion_sim_i2c.h"
+#include "sts3x.h"
+#include "sts3x_scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct recorded_trace {
+    const char* name;
+    const struct sensirion_sim_i2c_trace_point* points;
+    uint16_t count;
+};
+
+struct trace_replay_result {
+    uint32_t wakeups;
+    uint32_t failures;    /* measurements which returned an error */
+    uint64_t bus_usec;
+    uint64_t active_usec; /* of the sensor and the host */
+    int32_t max_error;    /* between the trace and the latest reading */
+    uint8_t max_repeatability;
+};
+
+/* an hour on a window sill: stable, then sunshine and a cloud */
+extern const struct recorded_trace window_sill_trace;
+/* an hour in a cold room with two short defrost cycles */
+extern const struct recorded_trace cold_room_trace;
+
+/**
+ * Replays a trace on the first simulated sensor until its last point, with
+ * the scheduler or a fixed 1 s loop if it is NULL. The trace starts at the
+ * current virtual time and the bus statistics are reset.
+ *
+ * @param recorded      the trace
+ * @param dev           the sensor of the fixed loop, ignored with a scheduler
+ * @param scheduler     the scheduler of the sensor, or NULL
+ * @param overhead_usec active time of the fixed loop per measurement in
+ *                      addition to the measurement duration
+ * @param result        the address for the result
+ */
+void replay_recorded_trace(const struct recorded_trace* recorded,
+                           struct sts3x_dev* dev,
+                           struct sts3x_scheduler* scheduler,
+                           uint32_t overhead_usec,
+                           struct trace_replay_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STS3X_TRACE_REPLAY_H */
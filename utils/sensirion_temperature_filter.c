@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sensirion_temperature_filter.h"
+
+static int32_t sensirion_ema_round(const struct sensirion_ema* ema) {
+    if (ema->shift == 0)
+        return (int32_t)ema->accumulator;
+    return (int32_t)((ema->accumulator + ((int64_t)1 << (ema->shift - 1))) >>
+                     ema->shift);
+}
+
+void sensirion_ema_init(struct sensirion_ema* ema, uint8_t shift) {
+    ema->accumulator = 0;
+    ema->shift =
+        shift > SENSIRION_EMA_MAX_SHIFT ? SENSIRION_EMA_MAX_SHIFT : shift;
+    ema->initialized = 0;
+}
+
+int32_t sensirion_ema_update(struct sensirion_ema* ema,
+                             int32_t temperature_milli_celsius) {
+    if (!ema->initialized) {
+        ema->accumulator =
+            (int64_t)temperature_milli_celsius * ((int64_t)1 << ema->shift);
+        ema->initialized = 1;
+    } else {
+        /* avg += (sample - avg) / 2^shift, scaled by 2^shift */
+        ema->accumulator += (int64_t)temperature_milli_celsius -
+                            (ema->accumulator >> ema->shift);
+    }
+    return sensirion_ema_round(ema);
+}
+
+int32_t sensirion_ema_get(const struct sensirion_ema* ema) {
+    return sensirion_ema_round(ema);
+}
+
+void sensirion_window_init(struct sensirion_window* window,
+                           struct sensirion_window_entry* entries,
+                           uint16_t size) {
+    window->entries = entries;
+    window->size = size;
+    window->count = 0;
+    window->next = 0;
+    window->min_head = 0;
+    window->min_count = 0;
+    window->max_head = 0;
+    window->max_count = 0;
+    window->sum = 0;
+}
+
+/* element of a candidate queue, the queues wrap around like the window */
+static uint16_t sensirion_window_wrap(const struct sensirion_window* window,
+                                      uint32_t index) {
+    return (uint16_t)(index % window->size);
+}
+
+void sensirion_window_update(struct sensirion_window* window,
+                             int32_t temperature_milli_celsius) {
+    struct sensirion_window_entry* entries = window->entries;
+    const uint16_t position = window->next;
+    uint16_t tail;
+
+    if (window->count == window->size) {
+        /* the oldest sample leaves the window, it is at most at the head */
+        window->sum -= entries[position].value;
+        if (entries[window->min_head].min_position == position) {
+            window->min_head =
+                sensirion_window_wrap(window, window->min_head + 1u);
+            window->min_count--;
+        }
+        if (entries[window->max_head].max_position == position) {
+            window->max_head =
+                sensirion_window_wrap(window, window->max_head + 1u);
+            window->max_count--;
+        }
+    } else {
+        window->count++;
+    }
+    entries[position].value = temperature_milli_celsius;
+    window->sum += temperature_milli_celsius;
+
+    /* candidates which are older and not smaller can never be the minimum */
+    while (window->min_count) {
+        tail = sensirion_window_wrap(window, (uint32_t)window->min_head +
+                                                 window->min_count - 1u);
+        if (entries[entries[tail].min_position].value <
+            temperature_milli_celsius)
+            break;
+        window->min_count--;
+    }
+    tail = sensirion_window_wrap(window, (uint32_t)window->min_head +
+                                             window->min_count);
+    entries[tail].min_position = position;
+    window->min_count++;
+
+    while (window->max_count) {
+        tail = sensirion_window_wrap(window, (uint32_t)window->max_head +
+                                                 window->max_count - 1u);
+        if (entries[entries[tail].max_position].value >
+            temperature_milli_celsius)
+            break;
+        window->max_count--;
+    }
+    tail = sensirion_window_wrap(window, (uint32_t)window->max_head +
+                                             window->max_count);
+    entries[tail].max_position = position;
+    window->max_count++;
+
+    window->next = sensirion_window_wrap(window, position + 1u);
+}
+
+uint16_t sensirion_window_count(const struct sensirion_window* window) {
+    return window->count;
+}
+
+int32_t sensirion_window_min(const struct sensirion_window* window) {
+    const struct sensirion_window_entry* entries = window->entries;
+
+    return entries[entries[window->min_head].min_position].value;
+}
+
+int32_t sensirion_window_max(const struct sensirion_window* window) {
+    const struct sensirion_window_entry* entries = window->entries;
+
+    return entries[entries[window->max_head].max_position].value;
+}
+
+int32_t sensirion_window_mean(const struct sensirion_window* window) {
+    const int64_t half = window->count / 2;
+
+    /* rounded half away from zero */
+    if (window->sum < 0)
+        return (int32_t)((window->sum - half) / window->count);
+    return (int32_t)((window->sum + half) / window->count);
+}
+
+void sensirion_deadband_init(struct sensirion_deadband* deadband,
+                             int32_t threshold, uint16_t max_skipped) {
+    deadband->threshold = threshold;
+    deadband->reported = 0;
+    deadband->max_skipped = max_skipped;
+    deadband->skipped = 0;
+    deadband->initialized = 0;
+}
+
+uint8_t sensirion_deadband_update(struct sensirion_deadband* deadband,
+                                  int32_t temperature_milli_celsius) {
+    int64_t change = (int64_t)temperature_milli_celsius - deadband->reported;
+
+    if (deadband->initialized && change <= deadband->threshold &&
+        change >= -(int64_t)deadband->threshold &&
+        (!deadband->max_skipped || deadband->skipped < deadband->max_skipped)) {
+        deadband->skipped++;
+        return 0;
+    }
+
+    deadband->reported = temperature_milli_celsius;
+    deadband->skipped = 0;
+    deadband->initialized = 1;
+    return 1;
+}
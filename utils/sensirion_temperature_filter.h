@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2026, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Streaming filters and aggregations of temperature measurements
+ *
+ * Allocation free building blocks to reduce a stream of measurements on the
+ * device before it is transmitted: an exponential moving average, the minimum,
+ * maximum and mean over a sliding window and a deadband filter which reports
+ * only significant changes. All of them operate in fixed point on temperatures
+ * in milli degree Celsius (e.g. as returned by sts3x_read()), keep constant
+ * state and take constant (amortized, for the window) time per sample.
+ */
+
+#ifndef SENSIRION_TEMPERATURE_FILTER_H
+#define SENSIRION_TEMPERATURE_FILTER_H
+#include "sensirion_arch_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSIRION_EMA_MAX_SHIFT 16
+
+/**
+ * Exponential moving average with a smoothing factor of 2^-shift, see
+ * sensirion_ema_init().
+ */
+struct sensirion_ema {
+    int64_t accumulator; /* average multiplied by 2^shift */
+    uint8_t shift;
+    uint8_t initialized; /* 0 until the first sample */
+};
+
+/**
+ * One sample of a sliding window, see sensirion_window_init(). Applications
+ * provide an array of these with one element per sample of the window.
+ */
+struct sensirion_window_entry {
+    int32_t value;
+    uint16_t min_position; /* element of the minimum candidate queue */
+    uint16_t max_position; /* element of the maximum candidate queue */
+};
+
+/**
+ * Minimum, maximum and mean over the last samples, see sensirion_window_init().
+ */
+struct sensirion_window {
+    struct sensirion_window_entry* entries;
+    uint16_t size;  /* number of entries */
+    uint16_t count; /* samples in the window, at most size */
+    uint16_t next;  /* entry of the next sample */
+    /* queues of minimum and maximum candidates, in order of arrival */
+    uint16_t min_head;
+    uint16_t min_count;
+    uint16_t max_head;
+    uint16_t max_count;
+    int64_t sum;
+};
+
+/**
+ * Report on change filter, see sensirion_deadband_init().
+ */
+struct sensirion_deadband {
+    int32_t threshold;
+    int32_t reported; /* last reported value */
+    uint16_t max_skipped;
+    uint16_t skipped; /* samples since the last report */
+    uint8_t initialized;
+};
+
+/**
+ * sensirion_ema_init() - Initialize an exponential moving average
+ *
+ * Each sample moves the average by 2^-shift of its difference to the average,
+ * i.e. a step is followed to ~63% after 2^shift samples.
+ *
+ * @param ema       The average to initialize.
+ *
+ * @param shift     The smoothing, 0 (no smoothing) to SENSIRION_EMA_MAX_SHIFT.
+ *                  Larger values are limited to SENSIRION_EMA_MAX_SHIFT.
+ */
+void sensirion_ema_init(struct sensirion_ema* ema, uint8_t shift);
+
+/**
+ * sensirion_ema_update() - Add a sample to an exponential moving average
+ *
+ * The first sample initializes the average.
+ *
+ * @param ema                           The average.
+ *
+ * @param temperature_milli_celsius     The sample.
+ *
+ * @return                              The updated average, rounded to the
+ *                                      nearest milli degree Celsius.
+ */
+int32_t sensirion_ema_update(struct sensirion_ema* ema,
+                             int32_t temperature_milli_celsius);
+
+/**
+ * sensirion_ema_get() - Return the current exponential moving average
+ *
+ * @param ema   The average.
+ *
+ * @return      The average, rounded to the nearest milli degree Celsius, 0
+ *              before the first sample.
+ */
+int32_t sensirion_ema_get(const struct sensirion_ema* ema);
+
+/**
+ * sensirion_window_init() - Initialize a sliding window
+ *
+ * The window covers the last size samples. Minimum and maximum are tracked
+ * with monotonic queues, so an update takes amortized constant time regardless
+ * of the window size.
+ *
+ * @param window    The window to initialize.
+ *
+ * @param entries   The storage of the window, must stay valid while the window
+ *                  is in use.
+ *
+ * @param size      The number of elements of entries, i.e. the window size, at
+ *                  least 1.
+ */
+void sensirion_window_init(struct sensirion_window* window,
+                           struct sensirion_window_entry* entries,
+                           uint16_t size);
+
+/**
+ * sensirion_window_update() - Add a sample to a sliding window
+ *
+ * If the window is full, the oldest sample is dropped.
+ *
+ * @param window                        The window.
+ *
+ * @param temperature_milli_celsius     The sample.
+ */
+void sensirion_window_update(struct sensirion_window* window,
+                             int32_t temperature_milli_celsius);
+
+/**
+ * sensirion_window_count() - Return the number of samples in a sliding window
+ *
+ * @param window    The window.
+ *
+ * @return          The number of samples, at most the window size.
+ */
+uint16_t sensirion_window_count(const struct sensirion_window* window);
+
+/**
+ * sensirion_window_min() - Return the minimum of a sliding window
+ *
+ * @param window    The window, must contain at least one sample.
+ *
+ * @return          The minimum in milli degree Celsius.
+ */
+int32_t sensirion_window_min(const struct sensirion_window* window);
+
+/**
+ * sensirion_window_max() - Return the maximum of a sliding window
+ *
+ * @param window    The window, must contain at least one sample.
+ *
+ * @return          The maximum in milli degree Celsius.
+ */
+int32_t sensirion_window_max(const struct sensirion_window* window);
+
+/**
+ * sensirion_window_mean() - Return the mean of a sliding window
+ *
+ * @param window    The window, must contain at least one sample.
+ *
+ * @return          The mean, rounded to the nearest milli degree Celsius.
+ */
+int32_t sensirion_window_mean(const struct sensirion_window* window);
+
+/**
+ * sensirion_deadband_init() - Initialize a report on change filter
+ *
+ * @param deadband      The filter to initialize.
+ *
+ * @param threshold     The change against the last reported value, in milli
+ *                      degree Celsius, which needs to be exceeded to report a
+ *                      sample.
+ *
+ * @param max_skipped   Report a sample at the latest after this many samples
+ *                      were skipped, e.g. as a sign of life. 0 to report only
+ *                      changes.
+ */
+void sensirion_deadband_init(struct sensirion_deadband* deadband,
+                             int32_t threshold, uint16_t max_skipped);
+
+/**
+ * sensirion_deadband_update() - Decide if a sample needs to be reported
+ *
+ * The first sample is always reported.
+ *
+ * @param deadband                      The filter.
+ *
+ * @param temperature_milli_celsius     The sample.
+ *
+ * @return                              1 if the sample should be reported,
+ *                                      else 0.
+ */
+uint8_t sensirion_deadband_update(struct sensirion_deadband* deadband,
+                                  int32_t temperature_milli_celsius);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSIRION_TEMPERATURE_FILTER_H */
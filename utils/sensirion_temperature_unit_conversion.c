@@ -31,6 +31,18 @@
 
 #include "sensirion_temperature_unit_conversion.h"
 
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+static int32_t sensirion_ticks_to_celsius(uint16_t ticks) {
+    /* Conversion equivalent to: 175 * ticks / 2^16 - 45, in milli degree
+     * Celsius. Fixed Point: 175000 / 2^16 = 21875 / 2^13 */
+    return ((21875 * (int32_t)ticks) >> 13) - 45000;
+}
+
 int32_t sensirion_celsius_to_fahrenheit(int32_t temperature_milli_celsius) {
     /* Conversion equivalent to: temperature_milli_celsius * 9.0/5.0 + 32000
      * Fixed Point: 9.0/5.0 * 2^12 = 7372.8
@@ -45,3 +57,140 @@ int32_t sensirion_fahrenheit_to_celsius(int32_t temperature_milli_fahrenheit) {
      * Using int32_t sized two's complement for negatives */
     return ((temperature_milli_fahrenheit - 32000) * 569) >> 10;
 }
+
+void sensirion_ticks_to_celsius_bulk(const uint16_t* ticks,
+                                     int32_t* temperatures_milli_celsius,
+                                     uint32_t count) {
+    uint32_t i = 0;
+
+#if defined(__SSE4_1__)
+    const __m128i factor = _mm_set1_epi32(21875);
+    const __m128i offset = _mm_set1_epi32(45000);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i t = _mm_loadu_si128((const __m128i*)&ticks[i]);
+        __m128i lo = _mm_unpacklo_epi16(t, zero);
+        __m128i hi = _mm_unpackhi_epi16(t, zero);
+        lo = _mm_sub_epi32(_mm_srai_epi32(_mm_mullo_epi32(lo, factor), 13),
+                           offset);
+        hi = _mm_sub_epi32(_mm_srai_epi32(_mm_mullo_epi32(hi, factor), 13),
+                           offset);
+        _mm_storeu_si128((__m128i*)&temperatures_milli_celsius[i], lo);
+        _mm_storeu_si128((__m128i*)&temperatures_milli_celsius[i + 4], hi);
+    }
+#elif defined(__ARM_NEON)
+    const int32x4_t offset = vdupq_n_s32(45000);
+
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t t = vld1q_u16(&ticks[i]);
+        int32x4_t lo = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(t)));
+        int32x4_t hi = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(t)));
+        lo = vsubq_s32(vshrq_n_s32(vmulq_n_s32(lo, 21875), 13), offset);
+        hi = vsubq_s32(vshrq_n_s32(vmulq_n_s32(hi, 21875), 13), offset);
+        vst1q_s32(&temperatures_milli_celsius[i], lo);
+        vst1q_s32(&temperatures_milli_celsius[i + 4], hi);
+    }
+#endif
+
+    /* plain loop for the remainder, auto-vectorized by the compiler when no
+     * intrinsics are available */
+    for (; i < count; ++i)
+        temperatures_milli_celsius[i] = sensirion_ticks_to_celsius(ticks[i]);
+}
+
+void sensirion_celsius_to_fahrenheit_bulk(
+    const int32_t* temperatures_milli_celsius,
+    int32_t* temperatures_milli_fahrenheit, uint32_t count) {
+    uint32_t i = 0;
+
+#if defined(__SSE4_1__)
+    const __m128i factor = _mm_set1_epi32(7373);
+    const __m128i offset = _mm_set1_epi32(32000);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i t =
+            _mm_loadu_si128((const __m128i*)&temperatures_milli_celsius[i]);
+        t = _mm_add_epi32(_mm_srai_epi32(_mm_mullo_epi32(t, factor), 12),
+                          offset);
+        _mm_storeu_si128((__m128i*)&temperatures_milli_fahrenheit[i], t);
+    }
+#elif defined(__ARM_NEON)
+    const int32x4_t offset = vdupq_n_s32(32000);
+
+    for (; i + 4 <= count; i += 4) {
+        int32x4_t t = vld1q_s32(&temperatures_milli_celsius[i]);
+        t = vaddq_s32(vshrq_n_s32(vmulq_n_s32(t, 7373), 12), offset);
+        vst1q_s32(&temperatures_milli_fahrenheit[i], t);
+    }
+#endif
+
+    for (; i < count; ++i)
+        temperatures_milli_fahrenheit[i] =
+            sensirion_celsius_to_fahrenheit(temperatures_milli_celsius[i]);
+}
+
+void sensirion_ticks_to_fahrenheit_bulk(const uint16_t* ticks,
+                                        int32_t* temperatures_milli_fahrenheit,
+                                        uint32_t count) {
+    /* convert in place, the intermediate Celsius values fit the output */
+    sensirion_ticks_to_celsius_bulk(ticks, temperatures_milli_fahrenheit,
+                                    count);
+    sensirion_celsius_to_fahrenheit_bulk(temperatures_milli_fahrenheit,
+                                         temperatures_milli_fahrenheit, count);
+}
+
+int8_t sensirion_temperature_calibration_init(
+    struct sensirion_temperature_calibration* calibration, uint32_t serial,
+    int32_t offset_milli_celsius, int32_t gain_micro) {
+    int64_t intercept;
+
+    if (gain_micro < 1 || gain_micro > SENSIRION_CALIBRATION_GAIN_MAX)
+        return -1;
+    intercept = (int64_t)offset_milli_celsius * 256 -
+                ((int64_t)gain_micro * 1152 + 50) / 100;
+    if ((int32_t)intercept != intercept)
+        return -1;
+
+    calibration->serial = serial;
+    calibration->slope = SENSIRION_CALIBRATION_SLOPE(gain_micro);
+    calibration->intercept = (int32_t)intercept;
+    return 0;
+}
+
+const struct sensirion_temperature_calibration*
+sensirion_temperature_calibration_find(
+    const struct sensirion_temperature_calibration* table, uint16_t count,
+    uint32_t serial) {
+    uint16_t i;
+
+    for (i = 0; i < count; ++i) {
+        if (table[i].serial == serial)
+            return &table[i];
+    }
+    return NULL;
+}
+
+int32_t sensirion_ticks_to_celsius_calibrated(uint16_t ticks,
+                                              const void* calibration) {
+    const struct sensirion_temperature_calibration* c =
+        (const struct sensirion_temperature_calibration*)calibration;
+
+    /* |slope * S_T| and |intercept * 2^16| are below 2^47, the sum can not
+     * overflow and the result fits 25 bits */
+    return (int32_t)(((int64_t)c->slope * ticks +
+                      (int64_t)c->intercept * 65536) >>
+                     24);
+}
+
+void sensirion_ticks_to_celsius_calibrated_bulk(
+    const uint16_t* ticks, int32_t* temperatures_milli_celsius, uint32_t count,
+    const struct sensirion_temperature_calibration* calibration) {
+    const int64_t slope = calibration->slope;
+    const int64_t intercept = (int64_t)calibration->intercept * 65536;
+    uint32_t i;
+
+    for (i = 0; i < count; ++i)
+        temperatures_milli_celsius[i] =
+            (int32_t)((slope * ticks[i] + intercept) >> 24);
+}
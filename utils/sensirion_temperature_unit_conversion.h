@@ -71,6 +71,201 @@ int32_t sensirion_celsius_to_fahrenheit(int32_t temperature_milli_celsius);
  */
 int32_t sensirion_fahrenheit_to_celsius(int32_t temperature_milli_fahrenheit);
 
+/**
+ * sensirion_ticks_to_celsius_bulk() - Convert an array of raw temperature
+ *                                     signals to degree Celsius
+ *
+ * Converts the raw temperature signal S_T of STS3x (and SHT3x) sensors, e.g. as
+ * returned by sts3x_read_ticks(), with the same fixed point formula as the
+ * driver: T = 175 * S_T / 2^16 - 45. The results are bit-exact to converting
+ * one value at a time. SSE4.1 or NEON is used when enabled at compile time
+ * (e.g. -msse4.1), otherwise the loop is left to the compiler's
+ * auto-vectorization.
+ *
+ * @param ticks                         The raw temperature signals.
+ *
+ * @param temperatures_milli_celsius    The address for the temperatures in
+ *                                      milli degree Celsius, i.e. degree
+ *                                      Celsius multiplied by 1000.
+ *
+ * @param count                         The number of values to convert.
+ */
+void sensirion_ticks_to_celsius_bulk(const uint16_t* ticks,
+                                     int32_t* temperatures_milli_celsius,
+                                     uint32_t count);
+
+/**
+ * sensirion_ticks_to_fahrenheit_bulk() - Convert an array of raw temperature
+ *                                        signals to degree Fahrenheit
+ *
+ * Equivalent to sensirion_ticks_to_celsius_bulk() followed by
+ * sensirion_celsius_to_fahrenheit() for each value.
+ *
+ * @param ticks                         The raw temperature signals.
+ *
+ * @param temperatures_milli_fahrenheit The address for the temperatures in
+ *                                      milli degree Fahrenheit, i.e. degree
+ *                                      Fahrenheit multiplied by 1000.
+ *
+ * @param count                         The number of values to convert.
+ */
+void sensirion_ticks_to_fahrenheit_bulk(const uint16_t* ticks,
+                                        int32_t* temperatures_milli_fahrenheit,
+                                        uint32_t count);
+
+/**
+ * sensirion_celsius_to_fahrenheit_bulk() - Convert an array of temperatures in
+ *                                          degree Celsius to degree Fahrenheit
+ *
+ * Equivalent to sensirion_celsius_to_fahrenheit() for each value. Input and
+ * output may be the same array.
+ *
+ * @param temperatures_milli_celsius    The temperatures in milli degree
+ *                                      Celsius.
+ *
+ * @param temperatures_milli_fahrenheit The address for the temperatures in
+ *                                      milli degree Fahrenheit.
+ *
+ * @param count                         The number of values to convert.
+ */
+void sensirion_celsius_to_fahrenheit_bulk(
+    const int32_t* temperatures_milli_celsius,
+    int32_t* temperatures_milli_fahrenheit, uint32_t count);
+
+/**
+ * Calibration of one sensor: the temperature from the standard formula is
+ * corrected to T_cal = gain * T + offset. The coefficients are stored fused
+ * with the standard formula, so that calibrated temperatures are computed from
+ * the raw signal with a single fixed point multiply-shift:
+ *
+ *   T_cal = (slope * S_T + intercept * 2^16) / 2^24
+ *
+ * with slope in 2^-24 and intercept in 2^-8 milli degree Celsius. Create
+ * entries with sensirion_temperature_calibration_init() or, for constant tables
+ * in flash, with SENSIRION_TEMPERATURE_CALIBRATION(). An entry takes 12 bytes.
+ */
+struct sensirion_temperature_calibration {
+    uint32_t serial;   /* serial number, see sts3x_read_serial() */
+    int32_t slope;     /* milli degree Celsius per tick, times 2^24 */
+    int32_t intercept; /* milli degree Celsius, times 2^8 */
+};
+
+/* gain of an uncalibrated sensor, gains are given in millionths */
+#define SENSIRION_CALIBRATION_GAIN_ONE 1000000
+/* largest gain whose slope fits the coefficient */
+#define SENSIRION_CALIBRATION_GAIN_MAX 47934780
+
+/* 175000 / 2^16 * 2^24 / 10^6 = 44.8, rounded, for gains > 0 */
+#define SENSIRION_CALIBRATION_SLOPE(gain_micro) \
+    ((int32_t)(((int64_t)(gain_micro)*448 + 5) / 10))
+/* (offset - 45000 * gain / 10^6) * 2^8, rounded, for gains > 0 */
+#define SENSIRION_CALIBRATION_INTERCEPT(offset_milli_celsius, gain_micro) \
+    ((int32_t)((int64_t)(offset_milli_celsius)*256 -                     \
+               ((int64_t)(gain_micro)*1152 + 50) / 100))
+
+/**
+ * SENSIRION_TEMPERATURE_CALIBRATION() - Initializer of a calibration table
+ *                                       entry
+ *
+ * Same as sensirion_temperature_calibration_init() for constant tables, but
+ * without the range checks.
+ */
+#define SENSIRION_TEMPERATURE_CALIBRATION(serial, offset_milli_celsius,  \
+                                          gain_micro)                    \
+    {                                                                    \
+        (serial), SENSIRION_CALIBRATION_SLOPE(gain_micro),               \
+            SENSIRION_CALIBRATION_INTERCEPT(offset_milli_celsius,        \
+                                            gain_micro)                  \
+    }
+
+/**
+ * sensirion_temperature_calibration_init() - Compute the coefficients of a
+ *                                            calibration table entry
+ *
+ * With a gain of SENSIRION_CALIBRATION_GAIN_ONE and an offset of 0, calibrated
+ * temperatures are bit-exact to the standard conversion.
+ *
+ * @param calibration                   The entry to initialize.
+ *
+ * @param serial                        The serial number of the sensor.
+ *
+ * @param offset_milli_celsius          The offset in milli degree Celsius.
+ *
+ * @param gain_micro                    The gain in millionths, i.e.
+ *                                      SENSIRION_CALIBRATION_GAIN_ONE for 1,
+ *                                      1 to SENSIRION_CALIBRATION_GAIN_MAX.
+ *
+ * @return                              0 on success, -1 if the gain or the
+ *                                      offset are out of range. The entry is
+ *                                      not changed on errors.
+ */
+int8_t sensirion_temperature_calibration_init(
+    struct sensirion_temperature_calibration* calibration, uint32_t serial,
+    int32_t offset_milli_celsius, int32_t gain_micro);
+
+/**
+ * sensirion_temperature_calibration_find() - Look up the calibration of a
+ *                                            sensor
+ *
+ * @param table                         The calibration table, in any order.
+ *
+ * @param count                         The number of entries of table.
+ *
+ * @param serial                        The serial number of the sensor, as
+ *                                      returned by sts3x_read_serial().
+ *
+ * @return                              The entry of the sensor, NULL if the
+ *                                      table does not contain the serial
+ *                                      number.
+ */
+const struct sensirion_temperature_calibration*
+sensirion_temperature_calibration_find(
+    const struct sensirion_temperature_calibration* table, uint16_t count,
+    uint32_t serial);
+
+/**
+ * sensirion_ticks_to_celsius_calibrated() - Convert a raw temperature signal
+ *                                           to calibrated degree Celsius
+ *
+ * The result is the value of gain * (175 * S_T / 2^16 - 45) + offset rounded
+ * down, with an error below 1.01 milli degree Celsius over the full range of
+ * S_T and all valid coefficients. The signature matches sts3x_convert_fn, so
+ * the function can be set as conversion of a sensor instance with
+ * sts3x_set_conversion_dev().
+ *
+ * @param ticks                         The raw temperature signal S_T.
+ *
+ * @param calibration                   The calibration of the sensor, a
+ *                                      struct
+ *                                      sensirion_temperature_calibration.
+ *
+ * @return                              The temperature in milli degree
+ *                                      Celsius, i.e. degree Celsius multiplied
+ *                                      by 1000.
+ */
+int32_t sensirion_ticks_to_celsius_calibrated(uint16_t ticks,
+                                              const void* calibration);
+
+/**
+ * sensirion_ticks_to_celsius_calibrated_bulk() - Convert an array of raw
+ *                                                temperature signals to
+ *                                                calibrated degree Celsius
+ *
+ * Equivalent to sensirion_ticks_to_celsius_calibrated() for each value.
+ *
+ * @param ticks                         The raw temperature signals.
+ *
+ * @param temperatures_milli_celsius    The address for the temperatures in
+ *                                      milli degree Celsius.
+ *
+ * @param count                         The number of values to convert.
+ *
+ * @param calibration                   The calibration of the sensor.
+ */
+void sensirion_ticks_to_celsius_calibrated_bulk(
+    const uint16_t* ticks, int32_t* temperatures_milli_celsius, uint32_t count,
+    const struct sensirion_temperature_calibration* calibration);
+
 #ifdef __cplusplus
 }
 #endif